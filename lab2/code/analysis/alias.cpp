@@ -0,0 +1,207 @@
+#include "alias.hpp"
+
+#include <algorithm>
+
+namespace IR {
+
+ModuleAliasInfo::ModuleAliasInfo(const Module &module)
+    : module(module), slots(module.functions.size()) {
+  size_t n = module.functions.size(), count = module.globals.size();
+  for (size_t f = 0; f < n; f++)
+    for (auto &block : module.functions[f]->blocks)
+      for (auto id : block.insts)
+        if ((*module.functions[f])[id].op == Opcode::Alloca)
+          slots[f][id] = count++;
+  any = count;
+
+  std::vector<int> calls(n, 0);
+  for (auto &func : module.functions)
+    for (auto &block : func->blocks)
+      for (auto id : block.insts)
+        if ((*func)[id].op == Opcode::Call) calls[(*func)[id].imm]++;
+  params.resize(n);
+  mod.assign(n, ObjectSet(any + 1));
+  ref.assign(n, ObjectSet(any + 1));
+  for (size_t f = 0; f < n; f++) {
+    auto &func = *module.functions[f];
+    // 没有调用者的函数（如 main）不知道形参从哪里来
+    for (auto type : func.param_types)
+      params[f].push_back(type == Type::Ptr && !calls[f] ? single(any)
+                                                          : ObjectSet(any + 1));
+    if (func.is_external) {
+      mod[f].set(any);
+      ref[f].set(any);
+    }
+  }
+
+  // 实参数组沿调用边流向形参，被调用者的读写并入调用者，直到不再变化
+  std::vector<AliasAnalysis> local;
+  local.reserve(n);
+  for (auto &func : module.functions) local.emplace_back(*func);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t f = 0; f < n; f++) {
+      auto &func = *module.functions[f];
+      if (func.is_external) continue;
+      auto &aa = local[f];
+      // 本函数的栈槽随返回消失，调用者看不到对它们的读写
+      auto outside = [&](ValueId ptr, ObjectSet &set) {
+        ValueId obj = aa.object(ptr);
+        if (obj != kNoValue && func[obj].op == Opcode::Alloca) return;
+        changed |= set.union_with(objects(f, obj));
+      };
+      for (auto &block : func.blocks)
+        for (auto id : block.insts) {
+          auto &inst = func[id];
+          if (inst.op == Opcode::Store) outside(inst.ops[1], mod[f]);
+          if (inst.op == Opcode::Load) outside(inst.ops[0], ref[f]);
+          if (inst.op != Opcode::Call || (inst.flags & kCallNoMemory))
+            continue;
+          int callee = inst.imm;
+          changed |= mod[f].union_with(mod[callee]);
+          changed |= ref[f].union_with(ref[callee]);
+          if (module.functions[callee]->is_external) continue;
+          for (uint32_t i = 0; i < inst.num_ops; i++)
+            if (func[inst.ops[i]].type == Type::Ptr)
+              changed |= params[callee][i].union_with(
+                  objects(f, aa.object(inst.ops[i])));
+        }
+    }
+  }
+}
+
+ModuleAliasInfo::ObjectSet ModuleAliasInfo::single(size_t object) const {
+  ObjectSet set(any + 1);
+  set.set(object);
+  return set;
+}
+
+ModuleAliasInfo::ObjectSet ModuleAliasInfo::objects(int func,
+                                                    ValueId object) const {
+  if (object == kNoValue) return single(any);
+  auto &inst = (*module.functions[func])[object];
+  switch (inst.op) {
+    case Opcode::Global: return single(inst.imm);
+    case Opcode::Arg: return params[func][inst.imm];
+    case Opcode::Alloca: {
+      auto it = slots[func].find(object);
+      return single(it == slots[func].end() ? any : it->second);
+    }
+    default: return single(any);
+  }
+}
+
+bool ModuleAliasInfo::intersects(const ObjectSet &a,
+                                 const ObjectSet &b) const {
+  if ((a.test(any) && b.any()) || (b.test(any) && a.any())) return true;
+  ObjectSet both = a;
+  both.intersect_with(b);
+  return both.any();
+}
+
+AliasAnalysis::AliasAnalysis(const Function &func)
+    : func(func),
+      objects(func.insts.size(), kNoValue),
+      escaped(func.insts.size(), false) {
+  for (ValueId v = 0; v < func.insts.size(); v++)
+    if (func[v].type == Type::Ptr) objects[v] = resolve(v);
+  for (auto &block : func.blocks)
+    for (auto id : block.insts) {
+      auto &inst = func[id];
+      if (inst.op != Opcode::Call) continue;
+      for (uint32_t i = 0; i < inst.num_ops; i++) {
+        if (func[inst.ops[i]].type != Type::Ptr) continue;
+        ValueId obj = objects[inst.ops[i]];
+        if (obj != kNoValue) escaped[obj] = true;
+      }
+    }
+}
+
+AliasAnalysis::AliasAnalysis(const Function &func,
+                             const ModuleAliasInfo &info, int index)
+    : AliasAnalysis(func) {
+  this->info = &info;
+  this->index = index;
+}
+
+ValueId AliasAnalysis::resolve(ValueId ptr) const {
+  // 指针 phi 的所有来源都基于同一对象时才能确定对象，如归纳出的指针
+  std::vector<ValueId> worklist = {ptr}, seen;
+  ValueId result = kNoValue;
+  while (!worklist.empty()) {
+    ValueId v = worklist.back();
+    worklist.pop_back();
+    while (func[v].op == Opcode::Gep) v = func[v].ops[0];
+    if (func[v].op != Opcode::Phi) {
+      if (result != kNoValue && result != v) return kNoValue;
+      result = v;
+      continue;
+    }
+    if (std::find(seen.begin(), seen.end(), v) != seen.end()) continue;
+    seen.push_back(v);
+    worklist.insert(worklist.end(), func[v].ops, func[v].ops + func[v].num_ops);
+  }
+  return result;
+}
+
+std::optional<int64_t> AliasAnalysis::offset(ValueId ptr) const {
+  int64_t total = 0;
+  while (func[ptr].op == Opcode::Gep) {
+    ValueId index = func[ptr].ops[1];
+    if (!func.is_const(index)) return std::nullopt;
+    total += func[index].imm;
+    ptr = func[ptr].ops[0];
+  }
+  if (func[ptr].op == Opcode::Phi) return std::nullopt;
+  return total;
+}
+
+bool AliasAnalysis::may_alias(ValueId p, ValueId q) const {
+  ValueId a = objects[p], b = objects[q];
+  if (a == kNoValue || b == kNoValue) return true;
+  if (a != b) {
+    // 数组形参可能指向调用者传入的数组，但不会指向本函数的栈槽
+    bool a_arg = func[a].op == Opcode::Arg, b_arg = func[b].op == Opcode::Arg;
+    if (!a_arg && !b_arg) return false;
+    if (func[a].op == Opcode::Alloca || func[b].op == Opcode::Alloca)
+      return false;
+    if (info)
+      return info->intersects(info->objects(index, a),
+                              info->objects(index, b));
+    return true;
+  }
+  auto x = offset(p), y = offset(q);
+  return !x || !y || *x == *y;
+}
+
+bool AliasAnalysis::must_alias(ValueId p, ValueId q) const {
+  if (p == q) return true;
+  if (objects[p] == kNoValue || objects[p] != objects[q]) return false;
+  auto x = offset(p), y = offset(q);
+  return x && y && *x == *y;
+}
+
+bool AliasAnalysis::may_write(ValueId inst, ValueId ptr) const {
+  auto &i = func[inst];
+  if (i.op == Opcode::Store) return may_alias(i.ops[1], ptr);
+  return i.op == Opcode::Call && reaches(i, ptr, true);
+}
+
+bool AliasAnalysis::may_read(ValueId inst, ValueId ptr) const {
+  auto &i = func[inst];
+  if (i.op == Opcode::Load) return may_alias(i.ops[0], ptr);
+  return i.op == Opcode::Call && reaches(i, ptr, false);
+}
+
+bool AliasAnalysis::reaches(const Inst &call, ValueId ptr, bool write) const {
+  if (call.flags & kCallNoMemory) return false;
+  ValueId obj = objects[ptr];
+  if (obj != kNoValue && func[obj].op == Opcode::Alloca && !escaped[obj])
+    return false;
+  if (!info) return true;
+  auto &set = write ? info->writes(call.imm) : info->reads(call.imm);
+  return info->intersects(info->objects(index, obj), set);
+}
+
+}  // namespace IR
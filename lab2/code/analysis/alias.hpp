@@ -0,0 +1,95 @@
+#ifndef ANALYSIS_ALIAS_HPP
+#define ANALYSIS_ALIAS_HPP
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis/bitvector.hpp"
+#include "ir/ir.hpp"
+
+namespace IR {
+
+/// @brief What the memory accesses of a whole module can reach, by index
+/// in Module::functions. The objects are the globals and the stack slots
+/// of every function. An array parameter points to the objects its callers
+/// pass for it, collected along the call graph, and a function writes
+/// (reads) the objects it stores to (loads from) outside its own frame,
+/// together with those of its callees. The last bit of an ObjectSet stands
+/// for any object, e.g. an address merged from two arrays.
+class ModuleAliasInfo {
+ public:
+  using ObjectSet = BitVector;
+
+  explicit ModuleAliasInfo(const Module &module);
+
+  /// @brief The objects the base `object` of an address in function `func`
+  /// may be: an alloca, a global, an argument, or kNoValue if unknown
+  ObjectSet objects(int func, ValueId object) const;
+  /// @brief The objects a call to `func` may write, excluding its frame
+  const ObjectSet &writes(int func) const { return mod[func]; }
+  /// @brief The objects a call to `func` may read, excluding its frame
+  const ObjectSet &reads(int func) const { return ref[func]; }
+
+  /// @brief Whether two object sets may share an object
+  bool intersects(const ObjectSet &a, const ObjectSet &b) const;
+
+ private:
+  const Module &module;
+  size_t any;
+  /// @brief The object of each stack slot, per function
+  std::vector<std::unordered_map<ValueId, size_t>> slots;
+  /// @brief The objects each parameter may point to, empty for `int`s
+  std::vector<std::vector<ObjectSet>> params;
+  std::vector<ObjectSet> mod, ref;
+
+  ObjectSet single(size_t object) const;
+};
+
+/// @brief Answers which memory accesses of a function may overlap. Every
+/// address is a chain of `gep`s and pointer phis on an object: a stack
+/// slot, a global, or an array parameter. Distinct stack slots and globals
+/// never overlap, a stack slot whose address is not passed to a call is
+/// invisible to callees, and two addresses with constant offsets into the
+/// same object overlap only if the offsets are equal. With a
+/// ModuleAliasInfo, array parameters overlap only the arrays their callers
+/// pass for them, and a call touches only what its callee can reach.
+class AliasAnalysis {
+ public:
+  explicit AliasAnalysis(const Function &func);
+  /// @brief Also use what `info` knows about function `index` of the module
+  AliasAnalysis(const Function &func, const ModuleAliasInfo &info,
+                int index);
+
+  /// @brief The alloca, global or argument `ptr` is derived from, kNoValue
+  /// if it is not known
+  ValueId object(ValueId ptr) const { return objects[ptr]; }
+  /// @brief The element offset of `ptr` from its object, if constant
+  std::optional<int64_t> offset(ValueId ptr) const;
+  /// @brief Whether the address of stack slot `object` reaches a call
+  bool escapes(ValueId object) const { return escaped[object]; }
+
+  /// @brief Whether `p` and `q` may point to the same element
+  bool may_alias(ValueId p, ValueId q) const;
+  /// @brief Whether `p` and `q` always point to the same element
+  bool must_alias(ValueId p, ValueId q) const;
+  /// @brief Whether executing `inst` may change the element at `ptr`
+  bool may_write(ValueId inst, ValueId ptr) const;
+  /// @brief Whether executing `inst` may read the element at `ptr`
+  bool may_read(ValueId inst, ValueId ptr) const;
+
+ private:
+  const Function &func;
+  const ModuleAliasInfo *info = nullptr;
+  int index = -1;
+  std::vector<ValueId> objects;
+  std::vector<bool> escaped;
+
+  ValueId resolve(ValueId ptr) const;
+  /// @brief Whether `call` may write (read) the element at `ptr`
+  bool reaches(const Inst &call, ValueId ptr, bool write) const;
+};
+
+}  // namespace IR
+
+#endif  // ANALYSIS_ALIAS_HPP
@@ -0,0 +1,94 @@
+#include "analysis_manager.hpp"
+
+#include <chrono>
+
+namespace IR {
+
+const char *analysis_to_string(AnalysisKind kind) {
+  switch (kind) {
+    case AnalysisKind::CFG: return "cfg";
+    case AnalysisKind::Dominators: return "dominators";
+    case AnalysisKind::Loops: return "loops";
+    case AnalysisKind::Liveness: return "liveness";
+    default: break;
+  }
+  return "unknown";
+}
+
+/// @brief The analysis `kind` is computed from, `kind` itself if none
+static AnalysisKind depends_on(AnalysisKind kind) {
+  switch (kind) {
+    case AnalysisKind::Dominators: return AnalysisKind::CFG;
+    case AnalysisKind::Loops: return AnalysisKind::Dominators;
+    case AnalysisKind::Liveness: return AnalysisKind::CFG;
+    default: break;
+  }
+  return kind;
+}
+
+template <typename T, typename Make>
+const T &AnalysisManager::get(std::shared_ptr<T> &slot, AnalysisKind kind,
+                              Make make) {
+  if (!slot) {
+    auto start = std::chrono::steady_clock::now();
+    slot = make();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    counts[static_cast<size_t>(kind)]++;
+    times[static_cast<size_t>(kind)] += elapsed.count();
+  }
+  return *slot;
+}
+
+const CFG &AnalysisManager::cfg(const Function &func) {
+  auto &cache = caches[&func];
+  return get(cache.cfg, AnalysisKind::CFG,
+             [&] { return std::make_shared<CFG>(func); });
+}
+
+const DominatorTree &AnalysisManager::dominators(const Function &func) {
+  auto &graph = cfg(func);
+  auto &cache = caches[&func];
+  return get(cache.dominators, AnalysisKind::Dominators,
+             [&] { return std::make_shared<DominatorTree>(graph); });
+}
+
+const LoopInfo &AnalysisManager::loops(const Function &func) {
+  auto &graph = cfg(func);
+  auto &dom = dominators(func);
+  auto &cache = caches[&func];
+  return get(cache.loops, AnalysisKind::Loops,
+             [&] { return std::make_shared<LoopInfo>(graph, dom); });
+}
+
+const Liveness &AnalysisManager::liveness(const Function &func) {
+  auto &graph = cfg(func);
+  auto &cache = caches[&func];
+  return get(cache.liveness, AnalysisKind::Liveness,
+             [&] { return std::make_shared<Liveness>(func, graph); });
+}
+
+void AnalysisManager::drop(Cache &cache, PreservedAnalyses preserved) {
+  // 依赖的分析失效时，由它算出的分析也一并失效
+  for (size_t i = 0; i < kNumKinds; i++) {
+    auto kind = static_cast<AnalysisKind>(i);
+    auto base = depends_on(kind);
+    if (base != kind && !preserved.preserved(base)) preserved.abandon(kind);
+  }
+  if (!preserved.preserved(AnalysisKind::CFG)) cache.cfg = nullptr;
+  if (!preserved.preserved(AnalysisKind::Dominators)) cache.dominators = nullptr;
+  if (!preserved.preserved(AnalysisKind::Loops)) cache.loops = nullptr;
+  if (!preserved.preserved(AnalysisKind::Liveness)) cache.liveness = nullptr;
+}
+
+void AnalysisManager::invalidate(const Function &func,
+                                 PreservedAnalyses preserved) {
+  auto it = caches.find(&func);
+  if (it != caches.end()) drop(it->second, preserved);
+}
+
+void AnalysisManager::invalidate_all(PreservedAnalyses preserved) {
+  for (auto &[func, cache] : caches) drop(cache, preserved);
+}
+
+}  // namespace IR
@@ -0,0 +1,95 @@
+#ifndef ANALYSIS_ANALYSIS_MANAGER_HPP
+#define ANALYSIS_ANALYSIS_MANAGER_HPP
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis/cfg.hpp"
+#include "analysis/dominators.hpp"
+#include "analysis/liveness.hpp"
+#include "analysis/loops.hpp"
+#include "ir/ir.hpp"
+
+namespace IR {
+
+/// @brief The cached analyses, each declared after the one it depends on
+enum class AnalysisKind : uint32_t {
+  CFG,
+  Dominators,  // depends on CFG
+  Loops,       // depends on Dominators
+  Liveness,    // depends on CFG
+  NumKinds,
+};
+const char *analysis_to_string(AnalysisKind kind);
+
+/// @brief The set of analyses a pass leaves valid
+class PreservedAnalyses {
+ public:
+  static PreservedAnalyses all() { return PreservedAnalyses(~0u); }
+  static PreservedAnalyses none() { return PreservedAnalyses(0); }
+
+  PreservedAnalyses &preserve(AnalysisKind kind) {
+    bits |= 1u << static_cast<uint32_t>(kind);
+    return *this;
+  }
+  bool preserved(AnalysisKind kind) const {
+    return bits & (1u << static_cast<uint32_t>(kind));
+  }
+  PreservedAnalyses &abandon(AnalysisKind kind) {
+    bits &= ~(1u << static_cast<uint32_t>(kind));
+    return *this;
+  }
+
+ private:
+  uint32_t bits;
+  explicit PreservedAnalyses(uint32_t bits) : bits(bits) {}
+};
+
+/// @brief Computes analyses of a function on first request and caches them
+/// until a pass invalidates them. An analysis is dropped together with the
+/// analyses it was computed from.
+class AnalysisManager {
+ public:
+  const CFG &cfg(const Function &func);
+  const DominatorTree &dominators(const Function &func);
+  const LoopInfo &loops(const Function &func);
+  const Liveness &liveness(const Function &func);
+
+  /// @brief Drop the analyses of `func` that are not preserved
+  void invalidate(const Function &func,
+                  PreservedAnalyses preserved = PreservedAnalyses::none());
+  /// @brief Drop the analyses of every function that are not preserved
+  void invalidate_all(PreservedAnalyses preserved = PreservedAnalyses::none());
+
+  /// @brief The number of times each analysis has been computed
+  int computed(AnalysisKind kind) const {
+    return counts[static_cast<size_t>(kind)];
+  }
+  /// @brief Seconds spent computing each analysis
+  double seconds(AnalysisKind kind) const {
+    return times[static_cast<size_t>(kind)];
+  }
+
+ private:
+  static constexpr size_t kNumKinds = static_cast<size_t>(AnalysisKind::NumKinds);
+
+  struct Cache {
+    std::shared_ptr<CFG> cfg;
+    std::shared_ptr<DominatorTree> dominators;
+    std::shared_ptr<LoopInfo> loops;
+    std::shared_ptr<Liveness> liveness;
+  };
+  std::unordered_map<const Function *, Cache> caches;
+  int counts[kNumKinds] = {};
+  double times[kNumKinds] = {};
+
+  template <typename T, typename Make>
+  const T &get(std::shared_ptr<T> &slot, AnalysisKind kind, Make make);
+  void drop(Cache &cache, PreservedAnalyses preserved);
+};
+
+}  // namespace IR
+
+#endif  // ANALYSIS_ANALYSIS_MANAGER_HPP
@@ -0,0 +1,58 @@
+#include "available_exprs.hpp"
+
+#include <map>
+#include <tuple>
+
+namespace IR {
+
+static bool is_expression(Opcode op) {
+  return is_binary(op) || op == Opcode::Gep || op == Opcode::Load;
+}
+
+AvailableExpressions::AvailableExpressions(const Function &func,
+                                           const CFG &cfg)
+    : exprs(func.insts.size(), kNoExpr) {
+  // 给相同的表达式分配同一个编号
+  std::map<std::tuple<Opcode, ValueId, ValueId>, uint32_t> numbering;
+  std::vector<uint32_t> loads;
+  for (auto bb : cfg.rpo)
+    for (auto id : func.blocks[bb].insts) {
+      auto &inst = func[id];
+      if (!is_expression(inst.op)) continue;
+      ValueId lhs = inst.ops[0], rhs = inst.num_ops > 1 ? inst.ops[1] : kNoValue;
+      if (is_commutative(inst.op) && rhs < lhs) std::swap(lhs, rhs);
+      auto [it, inserted] = numbering.emplace(std::make_tuple(inst.op, lhs, rhs), num);
+      if (inserted) {
+        if (inst.op == Opcode::Load) loads.push_back(num);
+        num++;
+      }
+      exprs[id] = it->second;
+    }
+
+  DataflowProblem problem(DataflowProblem::Direction::Forward,
+                          DataflowProblem::Meet::Intersect, num,
+                          func.num_blocks());
+  BitVector all_loads(num);
+  for (auto b : loads) all_loads.set(b);
+  for (auto bb : cfg.rpo) {
+    auto &gen = problem.gen[bb], &kill = problem.kill[bb];
+    for (auto id : func.blocks[bb].insts) {
+      auto op = func[id].op;
+      if (op == Opcode::Store || op == Opcode::Call) {
+        // 写内存之后之前读到的值都不再可用
+        gen.subtract(all_loads);
+        kill = all_loads;
+      } else if (exprs[id] != kNoExpr) {
+        gen.set(exprs[id]);
+      }
+    }
+  }
+  result = solve_dataflow(cfg, problem);
+}
+
+bool AvailableExpressions::available(BlockId bb, ValueId inst) const {
+  uint32_t e = expr(inst);
+  return e != kNoExpr && result.in[bb].size() == num && result.in[bb].test(e);
+}
+
+}  // namespace IR
@@ -0,0 +1,41 @@
+#ifndef ANALYSIS_AVAILABLE_EXPRS_HPP
+#define ANALYSIS_AVAILABLE_EXPRS_HPP
+
+#include <vector>
+
+#include "analysis/dataflow.hpp"
+#include "ir/ir.hpp"
+
+namespace IR {
+
+/// @brief The expressions computed on every path to each block. An
+/// expression is an arithmetic, comparison, gep or load instruction up to
+/// the order of commutative operands. Operands are SSA values, so only
+/// loads can be killed, by any store or call.
+class AvailableExpressions {
+ public:
+  static constexpr uint32_t kNoExpr = UINT32_MAX;
+
+  AvailableExpressions(const Function &func, const CFG &cfg);
+
+  /// @brief The expression computed by `inst`, kNoExpr for other
+  /// instructions
+  uint32_t expr(ValueId inst) const {
+    return inst < exprs.size() ? exprs[inst] : kNoExpr;
+  }
+  size_t num_exprs() const { return num; }
+  const BitVector &avail_in(BlockId bb) const { return result.in[bb]; }
+  const BitVector &avail_out(BlockId bb) const { return result.out[bb]; }
+  /// @brief Whether the expression of `inst` is available on entry to `bb`
+  bool available(BlockId bb, ValueId inst) const;
+  int visits() const { return result.visits; }
+
+ private:
+  std::vector<uint32_t> exprs;
+  size_t num = 0;
+  DataflowResult result;
+};
+
+}  // namespace IR
+
+#endif  // ANALYSIS_AVAILABLE_EXPRS_HPP
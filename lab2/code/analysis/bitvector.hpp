@@ -0,0 +1,118 @@
+#ifndef ANALYSIS_BITVECTOR_HPP
+#define ANALYSIS_BITVECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace IR {
+
+/// @brief A fixed-size set of small integers stored as dense 64-bit words.
+/// Set operations work a word at a time in plain loops the compiler can
+/// vectorize. Bits past size() are always zero.
+class BitVector {
+ public:
+  BitVector() = default;
+  explicit BitVector(size_t size, bool value = false)
+      : bits(size), words((size + 63) / 64, value ? ~uint64_t(0) : 0) {
+    if (value) clear_tail();
+  }
+
+  size_t size() const { return bits; }
+  bool test(size_t i) const { return words[i / 64] >> (i % 64) & 1; }
+  void set(size_t i) { words[i / 64] |= uint64_t(1) << (i % 64); }
+  void reset(size_t i) { words[i / 64] &= ~(uint64_t(1) << (i % 64)); }
+  void set_all() {
+    for (auto &w : words) w = ~uint64_t(0);
+    clear_tail();
+  }
+  void clear() {
+    for (auto &w : words) w = 0;
+  }
+
+  bool any() const {
+    for (auto w : words)
+      if (w) return true;
+    return false;
+  }
+  size_t count() const {
+    size_t n = 0;
+    for (auto w : words) n += __builtin_popcountll(w);
+    return n;
+  }
+
+  /// @brief this |= other
+  /// @return whether any bit changed
+  bool union_with(const BitVector &other) {
+    uint64_t changed = 0;
+    for (size_t i = 0; i < words.size(); i++) {
+      uint64_t w = words[i] | other.words[i];
+      changed |= w ^ words[i];
+      words[i] = w;
+    }
+    return changed;
+  }
+  /// @brief this &= other
+  /// @return whether any bit changed
+  bool intersect_with(const BitVector &other) {
+    uint64_t changed = 0;
+    for (size_t i = 0; i < words.size(); i++) {
+      uint64_t w = words[i] & other.words[i];
+      changed |= w ^ words[i];
+      words[i] = w;
+    }
+    return changed;
+  }
+  /// @brief this &= ~other
+  void subtract(const BitVector &other) {
+    for (size_t i = 0; i < words.size(); i++) words[i] &= ~other.words[i];
+  }
+  /// @brief this = gen | (in & ~kill), the usual transfer function
+  /// @return whether any bit changed
+  bool assign_transfer(const BitVector &gen, const BitVector &in,
+                       const BitVector &kill) {
+    uint64_t changed = 0;
+    for (size_t i = 0; i < words.size(); i++) {
+      uint64_t w = gen.words[i] | (in.words[i] & ~kill.words[i]);
+      changed |= w ^ words[i];
+      words[i] = w;
+    }
+    return changed;
+  }
+
+  /// @brief The first set bit at or after `from`, size() if none
+  size_t find_next(size_t from) const {
+    if (from >= bits) return bits;
+    size_t i = from / 64;
+    uint64_t w = words[i] & (~uint64_t(0) << (from % 64));
+    while (!w) {
+      if (++i == words.size()) return bits;
+      w = words[i];
+    }
+    return i * 64 + __builtin_ctzll(w);
+  }
+  /// @brief Call `f` with every set bit in increasing order
+  template <typename F>
+  void for_each(F f) const {
+    for (size_t i = 0; i < words.size(); i++)
+      for (uint64_t w = words[i]; w; w &= w - 1)
+        f(i * 64 + __builtin_ctzll(w));
+  }
+
+  bool operator==(const BitVector &other) const {
+    return bits == other.bits && words == other.words;
+  }
+  bool operator!=(const BitVector &other) const { return !(*this == other); }
+
+ private:
+  size_t bits = 0;
+  std::vector<uint64_t> words;
+
+  void clear_tail() {
+    if (bits % 64) words.back() &= (uint64_t(1) << (bits % 64)) - 1;
+  }
+};
+
+}  // namespace IR
+
+#endif  // ANALYSIS_BITVECTOR_HPP
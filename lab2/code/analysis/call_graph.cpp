@@ -0,0 +1,89 @@
+#include "call_graph.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace IR {
+
+CallGraph::CallGraph(const Module &module) {
+  size_t n = module.functions.size();
+  call_sites.resize(n);
+  callees.resize(n);
+  callers.resize(n);
+  scc_of.assign(n, -1);
+  is_recursive.assign(n, false);
+  calls_to.assign(n, 0);
+  for (size_t f = 0; f < n; f++) {
+    auto &func = *module.functions[f];
+    for (auto &block : func.blocks)
+      for (auto id : block.insts) {
+        if (func[id].op != Opcode::Call) continue;
+        int callee = func[id].imm;
+        call_sites[f].push_back(id);
+        calls_to[callee]++;
+        callees[f].push_back(callee);
+        if (callee == (int)f) is_recursive[f] = true;
+      }
+    auto &list = callees[f];
+    std::sort(list.begin(), list.end());
+    list.erase(std::unique(list.begin(), list.end()), list.end());
+    for (auto callee : list) callers[callee].push_back(f);
+  }
+
+  // Tarjan 算法按逆拓扑序给出强连通分量，被调用者先于调用者
+  std::vector<int> index(n, -1), low(n, 0), stack;
+  std::vector<bool> on_stack(n, false);
+  int counter = 0;
+  std::function<void(int)> connect = [&](int f) {
+    index[f] = low[f] = counter++;
+    stack.push_back(f);
+    on_stack[f] = true;
+    for (auto callee : callees[f]) {
+      if (index[callee] < 0) {
+        connect(callee);
+        low[f] = std::min(low[f], low[callee]);
+      } else if (on_stack[callee]) {
+        low[f] = std::min(low[f], index[callee]);
+      }
+    }
+    if (low[f] != index[f]) return;
+    std::vector<int> scc;
+    int g;
+    do {
+      g = stack.back();
+      stack.pop_back();
+      on_stack[g] = false;
+      scc_of[g] = sccs.size();
+      scc.push_back(g);
+    } while (g != f);
+    if (scc.size() > 1)
+      for (auto h : scc) is_recursive[h] = true;
+    sccs.push_back(scc);
+  };
+  for (size_t f = 0; f < n; f++)
+    if (index[f] < 0) connect(f);
+}
+
+std::vector<bool> CallGraph::unreachable(const Module &module) const {
+  // 从 main 和运行时函数出发仍能调用到的函数才需要保留
+  std::vector<bool> dead(module.functions.size(), true);
+  std::vector<int> worklist;
+  for (size_t f = 0; f < module.functions.size(); f++) {
+    auto &func = *module.functions[f];
+    if (!func.is_external && func.name != "main") continue;
+    dead[f] = false;
+    worklist.push_back(f);
+  }
+  while (!worklist.empty()) {
+    int f = worklist.back();
+    worklist.pop_back();
+    for (auto callee : callees[f])
+      if (dead[callee]) {
+        dead[callee] = false;
+        worklist.push_back(callee);
+      }
+  }
+  return dead;
+}
+
+}  // namespace IR
@@ -0,0 +1,40 @@
+#ifndef ANALYSIS_CALL_GRAPH_HPP
+#define ANALYSIS_CALL_GRAPH_HPP
+
+#include <vector>
+
+#include "ir/ir.hpp"
+
+namespace IR {
+
+/// @brief Which functions call which, by index in Module::functions. Every
+/// `call` was resolved from a FuncCall to the FuncDef of the same name
+/// during lowering.
+class CallGraph {
+ public:
+  explicit CallGraph(const Module &module);
+
+  /// @brief The call instructions in each function
+  std::vector<std::vector<ValueId>> call_sites;
+  /// @brief The distinct callees and callers of each function
+  std::vector<std::vector<int>> callees, callers;
+  /// @brief Strongly connected components, callees before callers
+  std::vector<std::vector<int>> sccs;
+  /// @brief The index in `sccs` of each function
+  std::vector<int> scc_of;
+
+  /// @brief Whether `func` can call itself, directly or not
+  bool recursive(int func) const { return is_recursive[func]; }
+  /// @brief The number of calls to `func` in the whole module
+  int num_calls(int func) const { return calls_to[func]; }
+  /// @brief The internal functions that main can no longer reach
+  std::vector<bool> unreachable(const Module &module) const;
+
+ private:
+  std::vector<bool> is_recursive;
+  std::vector<int> calls_to;
+};
+
+}  // namespace IR
+
+#endif  // ANALYSIS_CALL_GRAPH_HPP
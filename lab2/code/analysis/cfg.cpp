@@ -0,0 +1,40 @@
+#include "cfg.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace IR {
+
+CFG::CFG(const Function &func)
+    : preds(func.num_blocks()),
+      succs(func.num_blocks()),
+      rpo_index(func.num_blocks(), kNoIndex) {
+  for (BlockId bb = 0; bb < func.num_blocks(); bb++) {
+    if (func.blocks[bb].removed) continue;
+    succs[bb] = func.succs(bb);
+    for (auto succ : succs[bb]) preds[succ].push_back(bb);
+  }
+  if (func.blocks.empty() || func.blocks[0].removed) return;
+
+  // 用显式栈做深度优先遍历求后序，避免长函数递归过深
+  std::vector<bool> visited(func.num_blocks(), false);
+  std::vector<std::pair<BlockId, size_t>> stack{{0, 0}};
+  visited[0] = true;
+  while (!stack.empty()) {
+    auto &[bb, next] = stack.back();
+    if (next < succs[bb].size()) {
+      BlockId succ = succs[bb][next++];
+      if (!visited[succ]) {
+        visited[succ] = true;
+        stack.emplace_back(succ, 0);
+      }
+    } else {
+      rpo.push_back(bb);
+      stack.pop_back();
+    }
+  }
+  std::reverse(rpo.begin(), rpo.end());
+  for (uint32_t i = 0; i < rpo.size(); i++) rpo_index[rpo[i]] = i;
+}
+
+}  // namespace IR
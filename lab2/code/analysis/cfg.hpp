@@ -0,0 +1,33 @@
+#ifndef ANALYSIS_CFG_HPP
+#define ANALYSIS_CFG_HPP
+
+#include <vector>
+
+#include "ir/ir.hpp"
+
+namespace IR {
+
+/// @brief The control flow graph of a function: predecessor and successor
+/// lists of every block plus a reverse postorder of the reachable ones.
+class CFG {
+ public:
+  static constexpr uint32_t kNoIndex = UINT32_MAX;
+
+  /// @brief Predecessors of each block, one entry per edge
+  std::vector<std::vector<BlockId>> preds;
+  /// @brief Successors of each block in terminator order
+  std::vector<std::vector<BlockId>> succs;
+  /// @brief The blocks reachable from the entry in reverse postorder
+  std::vector<BlockId> rpo;
+  /// @brief The position of each block in rpo, kNoIndex if unreachable
+  std::vector<uint32_t> rpo_index;
+
+  explicit CFG(const Function &func);
+
+  size_t num_blocks() const { return preds.size(); }
+  bool reachable(BlockId bb) const { return rpo_index[bb] != kNoIndex; }
+};
+
+}  // namespace IR
+
+#endif  // ANALYSIS_CFG_HPP
@@ -0,0 +1,73 @@
+#include "dataflow.hpp"
+
+namespace IR {
+
+DataflowProblem::DataflowProblem(Direction direction, Meet meet,
+                                 size_t num_bits, size_t num_blocks)
+    : direction(direction),
+      meet(meet),
+      num_bits(num_bits),
+      gen(num_blocks, BitVector(num_bits)),
+      kill(num_blocks, BitVector(num_bits)),
+      boundary(num_bits) {}
+
+DataflowResult solve_dataflow(const CFG &cfg, const DataflowProblem &problem) {
+  bool forward = problem.direction == DataflowProblem::Direction::Forward;
+  bool is_union = problem.meet == DataflowProblem::Meet::Union;
+  size_t n = cfg.num_blocks();
+  DataflowResult result;
+  result.in.resize(n);
+  result.out.resize(n);
+
+  // 按处理顺序给可达的块编号，工作表就是这些编号上的位向量
+  std::vector<BlockId> order(cfg.rpo.begin(), cfg.rpo.end());
+  if (!forward) order.assign(cfg.rpo.rbegin(), cfg.rpo.rend());
+  std::vector<uint32_t> position(n, CFG::kNoIndex);
+  for (uint32_t i = 0; i < order.size(); i++) position[order[i]] = i;
+
+  // before 是沿分析方向流入块的集合，after 是流出的集合
+  auto &before = forward ? result.in : result.out;
+  auto &after = forward ? result.out : result.in;
+  for (auto bb : order) {
+    before[bb] = BitVector(problem.num_bits);
+    // 求交的问题从全集开始向下收敛
+    after[bb] = BitVector(problem.num_bits, !is_union);
+  }
+
+  BitVector pending(order.size(), true);
+  size_t cursor = 0;
+  while (true) {
+    size_t i = pending.find_next(cursor);
+    if (i == order.size()) i = pending.find_next(0);
+    if (i == order.size()) break;
+    pending.reset(i);
+    cursor = i + 1;
+    BlockId bb = order[i];
+
+    auto &sources = forward ? cfg.preds[bb] : cfg.succs[bb];
+    auto &meet = before[bb];
+    bool first = true;
+    for (auto src : sources) {
+      if (position[src] == CFG::kNoIndex) continue;
+      if (first) {
+        meet = after[src];
+        first = false;
+      } else if (is_union) {
+        meet.union_with(after[src]);
+      } else {
+        meet.intersect_with(after[src]);
+      }
+    }
+    if (first) meet = problem.boundary;
+    if (!problem.edge.empty()) meet.union_with(problem.edge[bb]);
+
+    result.visits++;
+    if (!after[bb].assign_transfer(problem.gen[bb], meet, problem.kill[bb]))
+      continue;
+    for (auto dest : forward ? cfg.succs[bb] : cfg.preds[bb])
+      if (position[dest] != CFG::kNoIndex) pending.set(position[dest]);
+  }
+  return result;
+}
+
+}  // namespace IR
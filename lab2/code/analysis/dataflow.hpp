@@ -0,0 +1,49 @@
+#ifndef ANALYSIS_DATAFLOW_HPP
+#define ANALYSIS_DATAFLOW_HPP
+
+#include <vector>
+
+#include "analysis/bitvector.hpp"
+#include "analysis/cfg.hpp"
+
+namespace IR {
+
+/// @brief A gen/kill dataflow problem over the blocks of a function. For a
+/// forward problem
+///   in(B)  = meet of out(P) over the predecessors P, plus edge(B)
+///   out(B) = gen(B) | (in(B) & ~kill(B))
+/// and a backward problem swaps in and out and uses the successors.
+struct DataflowProblem {
+  enum class Direction { Forward, Backward };
+  enum class Meet { Union, Intersect };
+
+  Direction direction = Direction::Forward;
+  Meet meet = Meet::Union;
+  size_t num_bits = 0;
+  /// @brief Indexed by BlockId
+  std::vector<BitVector> gen, kill;
+  /// @brief Facts added to the meet of a block, e.g. the phi operands a
+  /// block passes to its successors in liveness; may be left empty
+  std::vector<BitVector> edge;
+  /// @brief The facts flowing into the entry (forward) or out of the
+  /// blocks without successors (backward)
+  BitVector boundary;
+
+  DataflowProblem(Direction direction, Meet meet, size_t num_bits,
+                  size_t num_blocks);
+};
+
+struct DataflowResult {
+  /// @brief Indexed by BlockId, empty for unreachable blocks
+  std::vector<BitVector> in, out;
+  /// @brief The number of transfer function applications
+  int visits = 0;
+};
+
+/// @brief Solve the problem with a worklist that visits the blocks in
+/// reverse postorder (postorder for backward problems)
+DataflowResult solve_dataflow(const CFG &cfg, const DataflowProblem &problem);
+
+}  // namespace IR
+
+#endif  // ANALYSIS_DATAFLOW_HPP
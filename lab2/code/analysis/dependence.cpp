@@ -0,0 +1,93 @@
+#include "dependence.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace IR {
+
+std::optional<LinearIndex> linear_index(
+    const Function &func, ValueId v, const std::function<bool(ValueId)> &atom) {
+  auto &inst = func[v];
+  LinearIndex result;
+  if (inst.op == Opcode::Const) {
+    result.constant = inst.imm;
+    return result;
+  }
+  if (atom(v)) {
+    result.terms[v] = 1;
+    return result;
+  }
+  if (inst.op != Opcode::Add && inst.op != Opcode::Sub && inst.op != Opcode::Mul)
+    return std::nullopt;
+  auto lhs = linear_index(func, inst.ops[0], atom);
+  auto rhs = linear_index(func, inst.ops[1], atom);
+  if (!lhs || !rhs) return std::nullopt;
+  if (inst.op == Opcode::Mul) {
+    // 只允许乘以常数
+    if (!lhs->terms.empty() && !rhs->terms.empty()) return std::nullopt;
+    if (!lhs->terms.empty()) std::swap(lhs, rhs);
+    int64_t scale = lhs->constant;
+    result.constant = rhs->constant * scale;
+    for (auto &[value, coef] : rhs->terms)
+      if (coef * scale != 0) result.terms[value] = coef * scale;
+    return result;
+  }
+  int64_t sign = inst.op == Opcode::Add ? 1 : -1;
+  result = *lhs;
+  result.constant += sign * rhs->constant;
+  for (auto &[value, coef] : rhs->terms) {
+    result.terms[value] += sign * coef;
+    if (!result.terms[value]) result.terms.erase(value);
+  }
+  return result;
+}
+
+std::optional<std::vector<std::vector<int64_t>>> dependence_distances(
+    const LinearIndex &a, const LinearIndex &b,
+    const std::vector<LoopDimension> &dims) {
+  // 系数完全相同时 a(x) == b(x + d) 化为 sum(coef * step * d) == a.c - b.c
+  if (a.terms != b.terms || dims.empty()) return std::nullopt;
+  // 枚举除最内层以外的距离，最内层由整除直接求出
+  constexpr int64_t kMaxSpace = 1 << 22;
+  std::vector<int64_t> stride;
+  int64_t space = 1;
+  for (size_t k = 0; k < dims.size(); k++) {
+    if (!dims[k].trips) return std::nullopt;
+    stride.push_back(a.coefficient(dims[k].var) * dims[k].step);
+    if (k + 1 < dims.size()) space *= 2 * std::max<int64_t>(*dims[k].trips, 1);
+    if (space > kMaxSpace) return std::nullopt;
+  }
+
+  std::vector<std::vector<int64_t>> result;
+  std::vector<int64_t> d(dims.size(), 0);
+  size_t last = dims.size() - 1;
+  std::function<void(size_t, int64_t)> search = [&](size_t k, int64_t rest) {
+    if (k == last) {
+      int64_t range = *dims[k].trips - 1;
+      if (stride[k] == 0) {
+        if (rest != 0) return;
+        // 最内层不影响下标，任意距离都相同
+        for (int64_t x = -range; x <= range; x++) {
+          d[k] = x;
+          result.push_back(d);
+        }
+        return;
+      }
+      if (rest % stride[k] != 0) return;
+      int64_t x = rest / stride[k];
+      if (std::abs(x) > range) return;
+      d[k] = x;
+      result.push_back(d);
+      return;
+    }
+    int64_t range = *dims[k].trips - 1;
+    for (int64_t x = -range; x <= range; x++) {
+      d[k] = x;
+      search(k + 1, rest - stride[k] * x);
+    }
+  };
+  search(0, a.constant - b.constant);
+  return result;
+}
+
+}  // namespace IR
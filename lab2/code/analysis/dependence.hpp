@@ -0,0 +1,52 @@
+#ifndef ANALYSIS_DEPENDENCE_HPP
+#define ANALYSIS_DEPENDENCE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include "ir/ir.hpp"
+
+namespace IR {
+
+/// @brief An i32 index written as constant + sum of coefficient * value,
+/// e.g. `i * 64 + j + 1` for `a[i][j + 1]` in an `int a[N][64]`
+struct LinearIndex {
+  int64_t constant = 0;
+  /// @brief The coefficient of each value, zero coefficients are dropped
+  std::map<ValueId, int64_t> terms;
+
+  int64_t coefficient(ValueId v) const {
+    auto it = terms.find(v);
+    return it == terms.end() ? 0 : it->second;
+  }
+};
+
+/// @brief Decompose `v` through add, sub and multiplication by constants,
+/// stopping at the values for which `atom` holds
+/// @return std::nullopt if some part of the index is not linear
+std::optional<LinearIndex> linear_index(
+    const Function &func, ValueId v, const std::function<bool(ValueId)> &atom);
+
+/// @brief One loop of a nest: the induction variable, how much it grows
+/// per iteration and how many iterations there are, if known
+struct LoopDimension {
+  ValueId var;
+  int64_t step;
+  std::optional<int64_t> trips;
+};
+
+/// @brief The distance vectors, in iterations of each dimension from the
+/// outermost, for which `a` in some iteration and `b` that many iterations
+/// later access the same element. Only uniform pairs, which differ in the
+/// constant alone, over loops with known trip counts are solved.
+/// @return std::nullopt if the distances cannot be determined
+std::optional<std::vector<std::vector<int64_t>>> dependence_distances(
+    const LinearIndex &a, const LinearIndex &b,
+    const std::vector<LoopDimension> &dims);
+
+}  // namespace IR
+
+#endif  // ANALYSIS_DEPENDENCE_HPP
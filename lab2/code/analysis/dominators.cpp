@@ -0,0 +1,89 @@
+#include "dominators.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace IR {
+
+DominatorTree::DominatorTree(const CFG &cfg)
+    : idoms(cfg.num_blocks(), kNoBlock),
+      kids(cfg.num_blocks()),
+      pre(cfg.num_blocks(), CFG::kNoIndex),
+      post(cfg.num_blocks(), CFG::kNoIndex) {
+  if (cfg.rpo.empty()) return;
+  // 沿支配树向上走到两个块的最近公共祖先，rpo 序号小的更靠近根
+  auto intersect = [&](BlockId a, BlockId b) {
+    while (a != b) {
+      while (cfg.rpo_index[a] > cfg.rpo_index[b]) a = idoms[a];
+      while (cfg.rpo_index[b] > cfg.rpo_index[a]) b = idoms[b];
+    }
+    return a;
+  };
+  BlockId entry = cfg.rpo[0];
+  idoms[entry] = entry;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = 1; i < cfg.rpo.size(); i++) {
+      BlockId bb = cfg.rpo[i];
+      BlockId new_idom = kNoBlock;
+      for (auto pred : cfg.preds[bb]) {
+        if (idoms[pred] == kNoBlock) continue;
+        new_idom = new_idom == kNoBlock ? pred : intersect(pred, new_idom);
+      }
+      if (idoms[bb] != new_idom) {
+        idoms[bb] = new_idom;
+        changed = true;
+      }
+    }
+  }
+  idoms[entry] = kNoBlock;
+
+  for (size_t i = 1; i < cfg.rpo.size(); i++)
+    kids[idoms[cfg.rpo[i]]].push_back(cfg.rpo[i]);
+
+  // 给支配树编号，a 支配 b 当且仅当 b 的区间落在 a 的区间之内
+  uint32_t pre_num = 0, post_num = 0;
+  std::vector<std::pair<BlockId, size_t>> stack{{entry, 0}};
+  pre[entry] = pre_num++;
+  order.push_back(entry);
+  while (!stack.empty()) {
+    auto &[bb, next] = stack.back();
+    if (next < kids[bb].size()) {
+      BlockId child = kids[bb][next++];
+      pre[child] = pre_num++;
+      order.push_back(child);
+      stack.emplace_back(child, 0);
+    } else {
+      post[bb] = post_num++;
+      stack.pop_back();
+    }
+  }
+}
+
+bool DominatorTree::dominates(BlockId a, BlockId b) const {
+  if (pre[a] == CFG::kNoIndex || pre[b] == CFG::kNoIndex) return false;
+  return pre[a] <= pre[b] && post[b] <= post[a];
+}
+
+std::vector<std::vector<BlockId>> dominance_frontiers(const CFG &cfg,
+                                                      const DominatorTree &dom) {
+  std::vector<std::vector<BlockId>> frontiers(cfg.num_blocks());
+  for (auto bb : cfg.rpo) {
+    std::vector<BlockId> preds;
+    for (auto pred : cfg.preds[bb])
+      if (cfg.reachable(pred)) preds.push_back(pred);
+    if (preds.size() < 2) continue;
+    // 汇合点属于每个前驱直到其直接支配者之间所有块的支配边界
+    for (auto pred : preds) {
+      for (BlockId runner = pred; runner != kNoBlock && runner != dom.idom(bb);
+           runner = dom.idom(runner)) {
+        auto &frontier = frontiers[runner];
+        if (frontier.empty() || frontier.back() != bb) frontier.push_back(bb);
+      }
+    }
+  }
+  return frontiers;
+}
+
+}  // namespace IR
@@ -0,0 +1,42 @@
+#ifndef ANALYSIS_DOMINATORS_HPP
+#define ANALYSIS_DOMINATORS_HPP
+
+#include <vector>
+
+#include "analysis/cfg.hpp"
+
+namespace IR {
+
+/// @brief The dominator tree of the reachable blocks, computed with the
+/// iterative algorithm of Cooper, Harvey and Kennedy over reverse
+/// postorder.
+class DominatorTree {
+ public:
+  explicit DominatorTree(const CFG &cfg);
+
+  /// @brief The immediate dominator of `bb`, kNoBlock for the entry and
+  /// for unreachable blocks
+  BlockId idom(BlockId bb) const { return idoms[bb]; }
+  const std::vector<BlockId> &children(BlockId bb) const { return kids[bb]; }
+  /// @brief Whether every path from the entry to `b` passes through `a`.
+  /// A block dominates itself; unreachable blocks dominate nothing.
+  bool dominates(BlockId a, BlockId b) const;
+  /// @brief The reachable blocks in dominator tree preorder
+  const std::vector<BlockId> &preorder() const { return order; }
+
+ private:
+  std::vector<BlockId> idoms;
+  std::vector<std::vector<BlockId>> kids;
+  std::vector<BlockId> order;
+  /// @brief Preorder and postorder numbers of each block in the tree
+  std::vector<uint32_t> pre, post;
+};
+
+/// @brief The dominance frontier of every block: the blocks where its
+/// dominance ends, i.e. where definitions in it meet other definitions.
+std::vector<std::vector<BlockId>> dominance_frontiers(const CFG &cfg,
+                                                      const DominatorTree &dom);
+
+}  // namespace IR
+
+#endif  // ANALYSIS_DOMINATORS_HPP
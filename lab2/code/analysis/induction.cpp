@@ -0,0 +1,148 @@
+#include "induction.hpp"
+
+#include <cstdint>
+
+namespace IR {
+
+InductionInfo::InductionInfo(const Function &func, const LoopInfo &loops,
+                             const Loop &loop)
+    : func(func), loops(loops), loop(loop) {
+  if (loop.preheader == kNoBlock || loop.latches.size() != 1) return;
+  findBasic();
+  if (vars.empty()) return;
+  findExitTest();
+  // 派生变量由已知形式逐层推出，直到不再增加
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto bb : loop.blocks)
+      for (auto id : func.blocks[bb].insts) {
+        if (!is_binary(func[id].op) || forms.count(id)) continue;
+        AffineExpr form;
+        if (!derive(id, form)) continue;
+        forms[id] = form;
+        changed = true;
+      }
+  }
+}
+
+const AffineExpr *InductionInfo::affine(ValueId v) const {
+  auto it = forms.find(v);
+  return it == forms.end() ? nullptr : &it->second;
+}
+
+bool InductionInfo::invariant(ValueId v) const {
+  return func[v].block == kNoBlock || !loops.contains(&loop, func[v].block);
+}
+
+void InductionInfo::findBasic() {
+  BlockId latch = loop.latches[0];
+  for (auto phi : func.blocks[loop.header].insts) {
+    if (func[phi].op != Opcode::Phi) break;
+    if (func[phi].type != Type::I32 || func[phi].num_ops != 2) continue;
+    ValueId init = func.incoming(phi, loop.preheader);
+    ValueId next = func.incoming(phi, latch);
+    if (init == kNoValue || next == kNoValue) continue;
+    auto &inst = func[next];
+    int32_t step;
+    if (inst.op == Opcode::Add && inst.ops[0] == phi &&
+        func.is_const(inst.ops[1]))
+      step = func[inst.ops[1]].imm;
+    else if (inst.op == Opcode::Add && inst.ops[1] == phi &&
+             func.is_const(inst.ops[0]))
+      step = func[inst.ops[0]].imm;
+    else if (inst.op == Opcode::Sub && inst.ops[0] == phi &&
+             func.is_const(inst.ops[1]))
+      step = -(uint32_t)func[inst.ops[1]].imm;
+    else
+      continue;
+    forms[phi] = AffineExpr{(int)vars.size(), 1, kNoValue, 0};
+    vars.push_back(InductionVar{phi, init, next, step});
+  }
+}
+
+void InductionInfo::findExitTest() {
+  if (loop.exiting.size() != 1 || loop.exiting[0] != loop.header) return;
+  auto &br = func[func.terminator(loop.header)];
+  if (br.op != Opcode::CondBr || !loops.contains(&loop, br.targets[0]) ||
+      loops.contains(&loop, br.targets[1]))
+    return;
+  ValueId cmp = br.ops[0];
+  auto &inst = func[cmp];
+  if (!is_compare(inst.op) || inst.block != loop.header) return;
+  Opcode op = inst.op;
+  ValueId v = inst.ops[0], bound = inst.ops[1];
+  // 变量放在左边
+  if (!affine(v) || func[v].op != Opcode::Phi) {
+    std::swap(v, bound);
+    op = swap_compare(op);
+  }
+  auto form = affine(v);
+  if (!form || func[v].op != Opcode::Phi || !invariant(bound)) return;
+  int32_t step = vars[form->iv].step;
+  bool up = op == Opcode::Lt || op == Opcode::Le;
+  bool down = op == Opcode::Gt || op == Opcode::Ge;
+  if ((up && step > 0) || (down && step < 0))
+    test = ExitTest{form->iv, op, bound, cmp};
+}
+
+std::optional<int64_t> InductionInfo::trip_count() const {
+  if (!test) return std::nullopt;
+  auto &iv = vars[test->iv];
+  if (!func.is_const(iv.init) || !func.is_const(test->bound))
+    return std::nullopt;
+  int64_t init = func[iv.init].imm, bound = func[test->bound].imm;
+  int64_t step = iv.step;
+  // 统一成向上计数：init < bound (或 <=)
+  if (step < 0) {
+    init = -init;
+    bound = -bound;
+    step = -step;
+  }
+  bool inclusive = test->op == Opcode::Le || test->op == Opcode::Ge;
+  if (inclusive) bound++;
+  if (init >= bound) return 0;
+  int64_t trips = (bound - init + step - 1) / step;
+  // 最后一次自增的结果必须还在 i32 范围内，否则变量会回绕
+  int64_t last = func[iv.init].imm + trips * (int64_t)iv.step;
+  if (last < INT32_MIN || last > INT32_MAX) return std::nullopt;
+  return trips;
+}
+
+bool InductionInfo::derive(ValueId v, AffineExpr &result) const {
+  auto &inst = func[v];
+  ValueId lhs = inst.ops[0], rhs = inst.ops[1];
+  auto l = affine(lhs), r = affine(rhs);
+  // 交换律运算统一把归纳变量放在左边
+  if (!l && r && is_commutative(inst.op)) {
+    std::swap(lhs, rhs);
+    std::swap(l, r);
+  }
+  if (!l || r || !invariant(rhs)) return false;
+  result = *l;
+  bool constant = func.is_const(rhs);
+  uint32_t c = constant ? func[rhs].imm : 0;
+  switch (inst.op) {
+    case Opcode::Add:
+      if (constant) {
+        result.constant = (uint32_t)result.constant + c;
+        return true;
+      }
+      if (result.value != kNoValue) return false;
+      result.value = rhs;
+      return true;
+    case Opcode::Sub:
+      if (!constant) return false;
+      result.constant = (uint32_t)result.constant - c;
+      return true;
+    case Opcode::Mul:
+      if (!constant || result.value != kNoValue) return false;
+      result.scale = (uint32_t)result.scale * c;
+      result.constant = (uint32_t)result.constant * c;
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace IR
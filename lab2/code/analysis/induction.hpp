@@ -0,0 +1,82 @@
+#ifndef ANALYSIS_INDUCTION_HPP
+#define ANALYSIS_INDUCTION_HPP
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis/loops.hpp"
+#include "ir/ir.hpp"
+
+namespace IR {
+
+/// @brief A basic induction variable: a header phi that starts at `init`
+/// and grows by a constant `step` on every iteration
+struct InductionVar {
+  ValueId phi;
+  /// @brief The value flowing in from the preheader
+  ValueId init;
+  /// @brief phi + step, flowing back from the latch
+  ValueId next;
+  int32_t step;
+};
+
+/// @brief A derived induction variable: scale * iv + value + constant,
+/// where `value` is loop-invariant (kNoValue if absent). Arithmetic wraps
+/// like the i32 operations it was computed by.
+struct AffineExpr {
+  /// @brief The index of the basic variable in InductionInfo::ivs()
+  int iv;
+  int32_t scale;
+  ValueId value;
+  int32_t constant;
+};
+
+/// @brief The test `iv op bound` of a counted loop: evaluated in the
+/// header, the only block that leaves the loop, which keeps running while
+/// it holds. `op` is one of lt, le, gt, ge and the variable moves toward
+/// the bound.
+struct ExitTest {
+  int iv;
+  Opcode op;
+  /// @brief Loop-invariant
+  ValueId bound;
+  /// @brief The compare instruction
+  ValueId cmp;
+};
+
+/// @brief The basic and derived induction variables of one loop. Only loops
+/// with a preheader and a single latch are analysed.
+class InductionInfo {
+ public:
+  InductionInfo(const Function &func, const LoopInfo &loops, const Loop &loop);
+
+  const std::vector<InductionVar> &ivs() const { return vars; }
+  /// @brief The affine form of `v`, nullptr if it is not an induction
+  /// variable of the loop
+  const AffineExpr *affine(ValueId v) const;
+  /// @brief Whether `v` is defined outside the loop
+  bool invariant(ValueId v) const;
+  /// @brief The exit test if the loop is counted, nullptr otherwise
+  const ExitTest *exit_test() const { return test ? &*test : nullptr; }
+  /// @brief The number of times the body runs, known when the start and
+  /// the bound are constants and the variable does not wrap
+  std::optional<int64_t> trip_count() const;
+
+ private:
+  const Function &func;
+  const LoopInfo &loops;
+  const Loop &loop;
+  std::vector<InductionVar> vars;
+  std::unordered_map<ValueId, AffineExpr> forms;
+  std::optional<ExitTest> test;
+
+  void findBasic();
+  void findExitTest();
+  /// @brief The affine form of a binary instruction on known forms
+  bool derive(ValueId v, AffineExpr &result) const;
+};
+
+}  // namespace IR
+
+#endif  // ANALYSIS_INDUCTION_HPP
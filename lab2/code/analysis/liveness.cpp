@@ -0,0 +1,41 @@
+#include "liveness.hpp"
+
+namespace IR {
+
+Liveness::Liveness(const Function &func, const CFG &cfg)
+    : bits(func.insts.size(), kNoBit) {
+  for (auto &block : func.blocks)
+    for (auto id : block.insts)
+      if (func[id].type != Type::Void) {
+        bits[id] = values.size();
+        values.push_back(id);
+      }
+
+  DataflowProblem problem(DataflowProblem::Direction::Backward,
+                          DataflowProblem::Meet::Union, values.size(),
+                          func.num_blocks());
+  problem.edge.assign(func.num_blocks(), BitVector(values.size()));
+  for (auto bb : cfg.rpo) {
+    auto &gen = problem.gen[bb], &kill = problem.kill[bb];
+    for (auto id : func.blocks[bb].insts) {
+      auto &inst = func[id];
+      if (inst.op != Opcode::Phi)
+        for (uint32_t i = 0; i < inst.num_ops; i++) {
+          uint32_t b = bit(inst.ops[i]);
+          // 块内先用后定义的值才向上暴露
+          if (b != kNoBit && !kill.test(b)) gen.set(b);
+        }
+      if (bits[id] != kNoBit) kill.set(bits[id]);
+    }
+    // 后继块的 phi 从这个块取的值在块的出口活跃
+    for (auto succ : cfg.succs[bb])
+      for (auto id : func.blocks[succ].insts) {
+        if (func[id].op != Opcode::Phi) break;
+        ValueId in = func.incoming(id, bb);
+        if (in != kNoValue && bit(in) != kNoBit) problem.edge[bb].set(bit(in));
+      }
+  }
+  result = solve_dataflow(cfg, problem);
+}
+
+}  // namespace IR
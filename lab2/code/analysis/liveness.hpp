@@ -0,0 +1,46 @@
+#ifndef ANALYSIS_LIVENESS_HPP
+#define ANALYSIS_LIVENESS_HPP
+
+#include <vector>
+
+#include "analysis/dataflow.hpp"
+#include "ir/ir.hpp"
+
+namespace IR {
+
+/// @brief The SSA values live on entry to and exit from every block. A phi
+/// operand is live out of the predecessor it flows in from, not live into
+/// the phi's block.
+class Liveness {
+ public:
+  static constexpr uint32_t kNoBit = UINT32_MAX;
+
+  Liveness(const Function &func, const CFG &cfg);
+
+  bool live_in(BlockId bb, ValueId v) const { return live(result.in[bb], v); }
+  bool live_out(BlockId bb, ValueId v) const {
+    return live(result.out[bb], v);
+  }
+  const BitVector &live_in_set(BlockId bb) const { return result.in[bb]; }
+  const BitVector &live_out_set(BlockId bb) const { return result.out[bb]; }
+
+  /// @brief The bit of `v` in the sets, kNoBit for values that are not
+  /// tracked (constants, arguments and results of void instructions)
+  uint32_t bit(ValueId v) const { return v < bits.size() ? bits[v] : kNoBit; }
+  /// @brief The value of a bit
+  ValueId value(uint32_t bit) const { return values[bit]; }
+  int visits() const { return result.visits; }
+
+ private:
+  std::vector<uint32_t> bits;
+  std::vector<ValueId> values;
+  DataflowResult result;
+
+  bool live(const BitVector &set, ValueId v) const {
+    return bit(v) != kNoBit && set.size() != 0 && set.test(bit(v));
+  }
+};
+
+}  // namespace IR
+
+#endif  // ANALYSIS_LIVENESS_HPP
@@ -0,0 +1,93 @@
+#include "loops.hpp"
+
+#include <algorithm>
+
+namespace IR {
+
+LoopInfo::LoopInfo(const CFG &cfg, const DominatorTree &dom)
+    : innermost(cfg.num_blocks(), nullptr) {
+  // 按支配树后序处理循环头，内层循环先于外层循环被发现
+  auto &preorder = dom.preorder();
+  std::vector<std::vector<BlockId>> own_blocks;
+  for (auto it = preorder.rbegin(); it != preorder.rend(); ++it) {
+    BlockId header = *it;
+    std::vector<BlockId> worklist;
+    for (auto pred : cfg.preds[header])
+      if (dom.dominates(header, pred)) worklist.push_back(pred);
+    if (worklist.empty()) continue;
+
+    storage.push_back(std::make_unique<Loop>());
+    Loop *loop = storage.back().get();
+    loop->header = header;
+    order.push_back(loop);
+    std::vector<BlockId> own{header};
+    innermost[header] = loop;
+
+    // 从回边的源头逆着边走，直到循环头
+    while (!worklist.empty()) {
+      BlockId bb = worklist.back();
+      worklist.pop_back();
+      Loop *inner = innermost[bb];
+      if (!inner) {
+        innermost[bb] = loop;
+        own.push_back(bb);
+        for (auto pred : cfg.preds[bb])
+          if (cfg.reachable(pred)) worklist.push_back(pred);
+        continue;
+      }
+      // 已经属于某个循环：跳到它最外层的祖先，从那个循环头继续
+      while (inner->parent) inner = inner->parent;
+      if (inner == loop) continue;
+      inner->parent = loop;
+      loop->children.push_back(inner);
+      for (auto pred : cfg.preds[inner->header])
+        if (cfg.reachable(pred) && !contains(inner, pred))
+          worklist.push_back(pred);
+    }
+    own_blocks.push_back(std::move(own));
+  }
+
+  // 内层循环在前，所以子循环的块已经收集好了
+  for (size_t i = 0; i < order.size(); i++) {
+    Loop *loop = order[i];
+    loop->blocks = std::move(own_blocks[i]);
+    for (auto child : loop->children)
+      loop->blocks.insert(loop->blocks.end(), child->blocks.begin(),
+                          child->blocks.end());
+    if (!loop->parent) roots.push_back(loop);
+  }
+  for (auto it = order.rbegin(); it != order.rend(); ++it)
+    if ((*it)->parent) (*it)->depth = (*it)->parent->depth + 1;
+
+  for (auto loop : order) {
+    std::vector<BlockId> outside_preds;
+    for (auto pred : cfg.preds[loop->header]) {
+      if (!cfg.reachable(pred)) continue;
+      if (contains(loop, pred))
+        loop->latches.push_back(pred);
+      else
+        outside_preds.push_back(pred);
+    }
+    if (outside_preds.size() == 1 && cfg.succs[outside_preds[0]].size() == 1)
+      loop->preheader = outside_preds[0];
+    for (auto bb : loop->blocks) {
+      bool is_exiting = false;
+      for (auto succ : cfg.succs[bb]) {
+        if (contains(loop, succ)) continue;
+        is_exiting = true;
+        if (std::find(loop->exits.begin(), loop->exits.end(), succ) ==
+            loop->exits.end())
+          loop->exits.push_back(succ);
+      }
+      if (is_exiting) loop->exiting.push_back(bb);
+    }
+  }
+}
+
+bool LoopInfo::contains(const Loop *loop, BlockId bb) const {
+  for (Loop *l = innermost[bb]; l; l = l->parent)
+    if (l == loop) return true;
+  return false;
+}
+
+}  // namespace IR
@@ -0,0 +1,61 @@
+#ifndef ANALYSIS_LOOPS_HPP
+#define ANALYSIS_LOOPS_HPP
+
+#include <memory>
+#include <vector>
+
+#include "analysis/cfg.hpp"
+#include "analysis/dominators.hpp"
+
+namespace IR {
+
+/// @brief A natural loop: the header and every block that reaches one of
+/// its back edges without passing through the header.
+struct Loop {
+  BlockId header;
+  /// @brief The only block outside the loop that enters it, ending with an
+  /// unconditional branch to the header; kNoBlock if there is none
+  BlockId preheader = kNoBlock;
+  /// @brief All blocks of the loop including nested loops, header first
+  std::vector<BlockId> blocks;
+  /// @brief Sources of the back edges
+  std::vector<BlockId> latches;
+  /// @brief Blocks inside the loop with a successor outside
+  std::vector<BlockId> exiting;
+  /// @brief Blocks outside the loop with a predecessor inside
+  std::vector<BlockId> exits;
+  Loop *parent = nullptr;
+  std::vector<Loop *> children;
+  /// @brief 1 for outermost loops
+  int depth = 1;
+};
+
+/// @brief The loop nest of a function
+class LoopInfo {
+ public:
+  LoopInfo(const CFG &cfg, const DominatorTree &dom);
+
+  /// @brief Every loop, inner loops before the loops containing them
+  const std::vector<Loop *> &loops() const { return order; }
+  const std::vector<Loop *> &top_level() const { return roots; }
+  /// @brief The innermost loop containing `bb`, nullptr if none
+  Loop *loop_of(BlockId bb) const { return innermost[bb]; }
+  /// @brief The number of loops containing `bb`
+  int depth(BlockId bb) const {
+    return innermost[bb] ? innermost[bb]->depth : 0;
+  }
+  bool contains(const Loop *loop, BlockId bb) const;
+  bool is_header(BlockId bb) const {
+    return innermost[bb] && innermost[bb]->header == bb;
+  }
+
+ private:
+  std::vector<std::unique_ptr<Loop>> storage;
+  std::vector<Loop *> order;
+  std::vector<Loop *> roots;
+  std::vector<Loop *> innermost;
+};
+
+}  // namespace IR
+
+#endif  // ANALYSIS_LOOPS_HPP
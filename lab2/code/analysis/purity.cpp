@@ -0,0 +1,38 @@
+#include "purity.hpp"
+
+namespace IR {
+
+PurityAnalysis::PurityAnalysis(const Module &module)
+    : is_pure(module.functions.size(), false) {
+  size_t n = module.functions.size();
+  for (size_t f = 0; f < n; f++) {
+    auto &func = *module.functions[f];
+    if (func.is_external) continue;
+    bool pure = true;
+    for (auto type : func.param_types) pure &= type == Type::I32;
+    for (auto &block : func.blocks)
+      for (auto id : block.insts) {
+        auto &inst = func[id];
+        for (uint32_t i = 0; i < inst.num_ops; i++)
+          pure &= func[inst.ops[i]].op != Opcode::Global;
+      }
+    is_pure[f] = pure;
+  }
+  // 调用了非纯函数的函数也不纯，直到不再变化
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t f = 0; f < n; f++) {
+      if (!is_pure[f]) continue;
+      auto &func = *module.functions[f];
+      for (auto &block : func.blocks)
+        for (auto id : block.insts)
+          if (func[id].op == Opcode::Call && !is_pure[func[id].imm]) {
+            is_pure[f] = false;
+            changed = true;
+          }
+    }
+  }
+}
+
+}  // namespace IR
@@ -0,0 +1,29 @@
+#ifndef ANALYSIS_PURITY_HPP
+#define ANALYSIS_PURITY_HPP
+
+#include <vector>
+
+#include "ir/ir.hpp"
+
+namespace IR {
+
+/// @brief Finds the pure functions of a module, by index in
+/// Module::functions. A pure function takes only `int` parameters, never
+/// uses the address of a global, and calls only pure functions, so it
+/// cannot reach any memory but its own frame and neither `read` nor
+/// `write` can run inside it. Its result depends on nothing but its
+/// arguments, and a call can be skipped when the result is known.
+/// Recursion is assumed pure until shown otherwise.
+class PurityAnalysis {
+ public:
+  explicit PurityAnalysis(const Module &module);
+
+  bool pure(int func) const { return is_pure[func]; }
+
+ private:
+  std::vector<bool> is_pure;
+};
+
+}  // namespace IR
+
+#endif  // ANALYSIS_PURITY_HPP
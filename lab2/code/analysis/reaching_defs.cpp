@@ -0,0 +1,64 @@
+#include "reaching_defs.hpp"
+
+namespace IR {
+
+ReachingDefinitions::ReachingDefinitions(const Function &func, const CFG &cfg)
+    : func(func),
+      bits(func.insts.size(), UINT32_MAX),
+      stores_to(func.insts.size()) {
+  for (auto bb : cfg.rpo)
+    for (auto id : func.blocks[bb].insts) {
+      auto op = func[id].op;
+      if (op != Opcode::Store && op != Opcode::Call) continue;
+      bits[id] = def_insts.size();
+      def_insts.push_back(id);
+      if (op == Opcode::Store) stores_to[func[id].ops[1]].push_back(bits[id]);
+    }
+
+  DataflowProblem problem(DataflowProblem::Direction::Forward,
+                          DataflowProblem::Meet::Union, def_insts.size(),
+                          func.num_blocks());
+  for (auto bb : cfg.rpo) {
+    auto &gen = problem.gen[bb], &kill = problem.kill[bb];
+    for (auto id : func.blocks[bb].insts) {
+      if (bits[id] == UINT32_MAX) continue;
+      if (func[id].op == Opcode::Store) {
+        // 同一地址的其他写都被覆盖，块内更早的写也不再生成
+        for (auto b : stores_to[func[id].ops[1]]) {
+          kill.set(b);
+          gen.reset(b);
+        }
+      }
+      gen.set(bits[id]);
+      kill.reset(bits[id]);
+    }
+  }
+  result = solve_dataflow(cfg, problem);
+}
+
+void ReachingDefinitions::transfer(BitVector &set, ValueId id) const {
+  if (bits[id] == UINT32_MAX) return;
+  if (func[id].op == Opcode::Store)
+    for (auto b : stores_to[func[id].ops[1]]) set.reset(b);
+  set.set(bits[id]);
+}
+
+std::vector<ValueId> ReachingDefinitions::reaching(ValueId load) const {
+  BlockId bb = func[load].block;
+  if (bb == kNoBlock || result.in[bb].size() != def_insts.size()) return {};
+  BitVector set = result.in[bb];
+  for (auto id : func.blocks[bb].insts) {
+    if (id == load) break;
+    transfer(set, id);
+  }
+  std::vector<ValueId> res;
+  ValueId addr = func[load].ops[0];
+  set.for_each([&](size_t b) {
+    auto &def = func[def_insts[b]];
+    if (def.op == Opcode::Call || def.ops[1] == addr)
+      res.push_back(def_insts[b]);
+  });
+  return res;
+}
+
+}  // namespace IR
@@ -0,0 +1,42 @@
+#ifndef ANALYSIS_REACHING_DEFS_HPP
+#define ANALYSIS_REACHING_DEFS_HPP
+
+#include <vector>
+
+#include "analysis/dataflow.hpp"
+#include "ir/ir.hpp"
+
+namespace IR {
+
+/// @brief The memory definitions (stores and calls) that may reach every
+/// block. Registers are in SSA form, so memory is the only state with
+/// more than one definition. A store kills the earlier stores to the same
+/// address value; calls kill nothing.
+class ReachingDefinitions {
+ public:
+  ReachingDefinitions(const Function &func, const CFG &cfg);
+
+  /// @brief The definition of each bit
+  const std::vector<ValueId> &defs() const { return def_insts; }
+  const BitVector &reach_in(BlockId bb) const { return result.in[bb]; }
+  const BitVector &reach_out(BlockId bb) const { return result.out[bb]; }
+  /// @brief The stores to the address of `load` and the calls that reach it
+  std::vector<ValueId> reaching(ValueId load) const;
+  int visits() const { return result.visits; }
+
+ private:
+  const Function &func;
+  std::vector<ValueId> def_insts;
+  /// @brief The bit of each definition, indexed by ValueId
+  std::vector<uint32_t> bits;
+  /// @brief The bits of the stores to each address
+  std::vector<std::vector<uint32_t>> stores_to;
+  DataflowResult result;
+
+  /// @brief Apply the effect of one instruction to `set`
+  void transfer(BitVector &set, ValueId id) const;
+};
+
+}  // namespace IR
+
+#endif  // ANALYSIS_REACHING_DEFS_HPP
@@ -8,6 +8,7 @@
 #include <optional>
 
 #include "common.hpp"
+#include "semantic/initializer.hpp"
 #include "semantic/symbol_table.hpp"
 
 extern int yylineno;
@@ -240,11 +241,13 @@ using VarDeclPtr = std::shared_ptr<VarDecl>;
 class VarDecl : public Node {
  public:
   BasicType btype;
+  bool is_const = false;
   std::vector<VarDefPtr> defs;
   VarDecl(VarDefPtr def) : btype(BasicType::Unknown) { add_def(def); }
   void add_def(VarDefPtr def) { defs.push_back(def); }
   std::string to_string() override {
-    return "VarDecl <btype: " + std::string(type_to_string(btype)) + ">";
+    return "VarDecl <btype: " + std::string(is_const ? "const " : "") +
+           std::string(type_to_string(btype)) + ">";
   }
   std::vector<NodePtr> get_children() override {
     return std::vector<NodePtr>(defs.begin(), defs.end());
@@ -255,14 +258,13 @@ class ArrLists;
 using ArrListsPtr = std::shared_ptr<ArrLists>;
 class ArrLists : public Node {
 	public:
-		std::vector<IntConstPtr> args;
+		/// 各维的长度，类型检查后都会被替换为 IntConst
+		std::vector<NodePtr> args;
 		ArrLists() : args({}) {}
 		ArrLists(ArrListsPtr ast) : args(ast->args) {}
-		void add_list(IntConstPtr list) { args.push_back(list); }
+		void add_list(NodePtr list) { args.push_back(list); }
 		std::string to_string() override { return "ArrLists"; }
-		std::vector<NodePtr> get_children() override {
-			return std::vector<NodePtr>(args.begin(), args.end());
-		}
+		std::vector<NodePtr> get_children() override { return args; }
 };
 
 class ArrDef;
@@ -272,6 +274,7 @@ class ArrDef : public Node {
   std::string ident;
 	ArrListsPtr arr;
 	std::optional<NodePtr> val;
+	InitImagePtr image;
 	SymbolPtr symbol;
   ArrDef(char const *ident) : ident(ident) {}
   std::string to_string() override { return "ArrDef <ident: " + ident + ">"; }
@@ -283,11 +286,13 @@ using ArrDeclPtr = std::shared_ptr<ArrDecl>;
 class ArrDecl : public Node {
  public:
   BasicType btype;
+  bool is_const = false;
   std::vector<ArrDefPtr> defs;
   ArrDecl(ArrDefPtr def) : btype(BasicType::Unknown) { add_def(def); }
   void add_def(ArrDefPtr def) { defs.push_back(def); }
   std::string to_string() override {
-    return "ArrDecl <btype: " + std::string(type_to_string(btype)) + ">";
+    return "ArrDecl <btype: " + std::string(is_const ? "const " : "") +
+           std::string(type_to_string(btype)) + ">";
   }
   std::vector<NodePtr> get_children() override {
     return std::vector<NodePtr>(defs.begin(), defs.end());
@@ -301,7 +306,9 @@ class FuncFParam : public Node {
 		BasicType btype;
 		std::string name;
 		bool is_arr;
+		/// 数组参数除第一维以外的维度
 		ArrListsPtr args;
+		SymbolPtr symbol;
 		FuncFParam(BasicType btype, char const *name, bool is_arr) : 
 								btype(btype), name(name), is_arr(is_arr), args({}) {}
 		FuncFParam(BasicType btype, char const *name, bool is_arr, ArrListsPtr args) : 
@@ -0,0 +1,52 @@
+#ifndef IR_ARENA_HPP
+#define IR_ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace IR {
+
+/// @brief Bump allocator for trivially copyable IR data such as operand
+/// lists. Memory is never returned individually, everything is released
+/// together with the arena.
+class Arena {
+ public:
+  Arena() = default;
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  /// @brief Allocate uninitialized storage for `n` objects of type T
+  template <typename T>
+  T *alloc(size_t n) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Arena only holds trivially copyable data");
+    if (n == 0) return nullptr;
+    size_t align = alignof(T);
+    size_t offset = (used + align - 1) & ~(align - 1);
+    size_t bytes = n * sizeof(T);
+    if (chunks.empty() || offset + bytes > capacity) {
+      capacity = bytes > kChunkSize ? bytes : kChunkSize;
+      chunks.emplace_back(new char[capacity]);
+      total += capacity;
+      offset = 0;
+    }
+    used = offset + bytes;
+    return reinterpret_cast<T *>(chunks.back().get() + offset);
+  }
+
+  /// @brief The number of bytes reserved from the system
+  size_t reserved() const { return total; }
+
+ private:
+  static constexpr size_t kChunkSize = 16 * 1024;
+  std::vector<std::unique_ptr<char[]>> chunks;
+  size_t used = 0;
+  size_t capacity = 0;
+  size_t total = 0;
+};
+
+}  // namespace IR
+
+#endif  // IR_ARENA_HPP
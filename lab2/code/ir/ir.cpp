@@ -0,0 +1,471 @@
+#include "ir.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "semantic/const_eval.hpp"
+
+namespace IR {
+
+const char *type_to_string(Type type) {
+  switch (type) {
+    case Type::Void: return "void";
+    case Type::I32: return "i32";
+    case Type::Ptr: return "ptr";
+  }
+  return "unknown";
+}
+
+const char *opcode_to_string(Opcode op) {
+  switch (op) {
+    case Opcode::Const: return "const";
+    case Opcode::Arg: return "arg";
+    case Opcode::Global: return "global";
+    case Opcode::Undef: return "undef";
+    case Opcode::Add: return "add";
+    case Opcode::Sub: return "sub";
+    case Opcode::Mul: return "mul";
+    case Opcode::Div: return "div";
+    case Opcode::Mod: return "mod";
+    case Opcode::MulHi: return "mulhi";
+    case Opcode::Shl: return "shl";
+    case Opcode::AShr: return "ashr";
+    case Opcode::LShr: return "lshr";
+    case Opcode::Lt: return "lt";
+    case Opcode::Le: return "le";
+    case Opcode::Gt: return "gt";
+    case Opcode::Ge: return "ge";
+    case Opcode::Eq: return "eq";
+    case Opcode::Ne: return "ne";
+    case Opcode::Select: return "select";
+    case Opcode::Alloca: return "alloca";
+    case Opcode::Load: return "load";
+    case Opcode::Store: return "store";
+    case Opcode::Gep: return "gep";
+    case Opcode::Call: return "call";
+    case Opcode::Phi: return "phi";
+    case Opcode::Br: return "br";
+    case Opcode::CondBr: return "condbr";
+    case Opcode::Ret: return "ret";
+  }
+  return "unknown";
+}
+
+Opcode from_binary_op(BinaryOp op) {
+  switch (op) {
+    case BinaryOp::Add: return Opcode::Add;
+    case BinaryOp::Sub: return Opcode::Sub;
+    case BinaryOp::Mul: return Opcode::Mul;
+    case BinaryOp::Div: return Opcode::Div;
+    case BinaryOp::Mod: return Opcode::Mod;
+    case BinaryOp::Les: return Opcode::Lt;
+    case BinaryOp::Leq: return Opcode::Le;
+    case BinaryOp::Gre: return Opcode::Gt;
+    case BinaryOp::Geq: return Opcode::Ge;
+    case BinaryOp::Eql: return Opcode::Eq;
+    case BinaryOp::Neq: return Opcode::Ne;
+    default: break;
+  }
+  ASSERT(false, std::string("No IR opcode for ") + op_to_string(op));
+  return Opcode::Undef;
+}
+
+BinaryOp to_binary_op(Opcode op) {
+  switch (op) {
+    case Opcode::Add: return BinaryOp::Add;
+    case Opcode::Sub: return BinaryOp::Sub;
+    case Opcode::Mul: return BinaryOp::Mul;
+    case Opcode::Div: return BinaryOp::Div;
+    case Opcode::Mod: return BinaryOp::Mod;
+    case Opcode::Lt: return BinaryOp::Les;
+    case Opcode::Le: return BinaryOp::Leq;
+    case Opcode::Gt: return BinaryOp::Gre;
+    case Opcode::Ge: return BinaryOp::Geq;
+    case Opcode::Eq: return BinaryOp::Eql;
+    case Opcode::Ne: return BinaryOp::Neq;
+    default: break;
+  }
+  ASSERT(false, std::string("Not a binary opcode: ") + opcode_to_string(op));
+  return BinaryOp::Add;
+}
+
+std::optional<int> eval_binary(Opcode op, int lhs, int rhs) {
+  uint32_t a = lhs, b = rhs;
+  switch (op) {
+    case Opcode::MulHi: return (int)(((int64_t)lhs * rhs) >> 32);
+    case Opcode::Shl: return (int)(a << (b & 31));
+    case Opcode::AShr: return lhs >> (b & 31);
+    case Opcode::LShr: return (int)(a >> (b & 31));
+    default: return eval_binary_op(to_binary_op(op), lhs, rhs);
+  }
+}
+
+Function::Function(std::string name, Type ret_type,
+                   std::vector<Type> param_types, bool is_external)
+    : name(name),
+      ret_type(ret_type),
+      param_types(param_types),
+      is_external(is_external) {
+  for (size_t i = 0; i < param_types.size(); i++)
+    args.push_back(new_value(Opcode::Arg, param_types[i], i));
+}
+
+ValueId Function::new_value(Opcode op, Type type, int32_t imm) {
+  Inst inst;
+  inst.op = op;
+  inst.type = type;
+  inst.imm = imm;
+  insts.push_back(inst);
+  return insts.size() - 1;
+}
+
+ValueId Function::const_int(int value) {
+  auto it = consts.find(value);
+  if (it != consts.end()) return it->second;
+  return consts[value] = new_value(Opcode::Const, Type::I32, value);
+}
+
+ValueId Function::undef(Type type) {
+  auto it = undefs.find((int)type);
+  if (it != undefs.end()) return it->second;
+  return undefs[(int)type] = new_value(Opcode::Undef, type, 0);
+}
+
+ValueId Function::global_addr(int index) {
+  auto it = globals.find(index);
+  if (it != globals.end()) return it->second;
+  return globals[index] = new_value(Opcode::Global, Type::Ptr, index);
+}
+
+void Function::grow(Inst &inst, uint32_t capacity) {
+  // 旧的操作数数组留在 arena 中，随函数一起释放
+  auto ops = arena.alloc<ValueId>(capacity);
+  auto targets = arena.alloc<BlockId>(capacity);
+  if (inst.num_ops) memcpy(ops, inst.ops, inst.num_ops * sizeof(ValueId));
+  if (inst.num_targets)
+    memcpy(targets, inst.targets, inst.num_targets * sizeof(BlockId));
+  inst.ops = ops;
+  inst.targets = targets;
+  inst.capacity = capacity;
+}
+
+ValueId Function::create(Opcode op, Type type, const std::vector<ValueId> &ops,
+                         const std::vector<BlockId> &targets, int32_t imm) {
+  ValueId id = new_value(op, type, imm);
+  auto &inst = insts[id];
+  uint32_t n = std::max(ops.size(), targets.size());
+  if (n) grow(inst, n);
+  inst.num_ops = ops.size();
+  inst.num_targets = targets.size();
+  std::copy(ops.begin(), ops.end(), inst.ops);
+  std::copy(targets.begin(), targets.end(), inst.targets);
+  return id;
+}
+
+void Function::add_incoming(ValueId phi, ValueId value, BlockId from) {
+  auto &inst = insts[phi];
+  ASSERT(inst.op == Opcode::Phi, "add_incoming on a non-phi value");
+  if (inst.num_ops == inst.capacity)
+    grow(inst, inst.capacity ? inst.capacity * 2 : 2);
+  inst.ops[inst.num_ops++] = value;
+  inst.targets[inst.num_targets++] = from;
+}
+
+void Function::remove_incoming(ValueId phi, BlockId from) {
+  auto &inst = insts[phi];
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < inst.num_ops; i++)
+    if (inst.targets[i] != from) {
+      inst.ops[n] = inst.ops[i];
+      inst.targets[n] = inst.targets[i];
+      n++;
+    }
+  inst.num_ops = inst.num_targets = n;
+}
+
+ValueId Function::incoming(ValueId phi, BlockId from) const {
+  auto &inst = insts[phi];
+  for (uint32_t i = 0; i < inst.num_ops; i++)
+    if (inst.targets[i] == from) return inst.ops[i];
+  return kNoValue;
+}
+
+void Function::replace_incoming_block(BlockId bb, BlockId from, BlockId to) {
+  for (auto id : blocks[bb].insts) {
+    auto &inst = insts[id];
+    if (inst.op != Opcode::Phi) break;
+    for (uint32_t i = 0; i < inst.num_targets; i++)
+      if (inst.targets[i] == from) inst.targets[i] = to;
+  }
+}
+
+BlockId Function::add_block() {
+  blocks.emplace_back();
+  return blocks.size() - 1;
+}
+
+void Function::append(BlockId bb, ValueId inst) {
+  insts[inst].block = bb;
+  blocks[bb].insts.push_back(inst);
+}
+
+void Function::insert_before(ValueId pos, ValueId inst) {
+  BlockId bb = insts[pos].block;
+  auto &list = blocks[bb].insts;
+  list.insert(std::find(list.begin(), list.end(), pos), inst);
+  insts[inst].block = bb;
+}
+
+void Function::insert_before_terminator(BlockId bb, ValueId inst) {
+  ValueId term = terminator(bb);
+  if (term == kNoValue)
+    append(bb, inst);
+  else
+    insert_before(term, inst);
+}
+
+void Function::insert_after_phis(BlockId bb, ValueId inst) {
+  auto &list = blocks[bb].insts;
+  auto it = list.begin();
+  while (it != list.end() && insts[*it].op == Opcode::Phi) ++it;
+  list.insert(it, inst);
+  insts[inst].block = bb;
+}
+
+void Function::detach(ValueId inst) {
+  BlockId bb = insts[inst].block;
+  if (bb == kNoBlock) return;
+  auto &list = blocks[bb].insts;
+  list.erase(std::find(list.begin(), list.end(), inst));
+  insts[inst].block = kNoBlock;
+}
+
+void Function::remove_insts(const std::vector<bool> &dead) {
+  for (auto &block : blocks) {
+    auto &list = block.insts;
+    auto is_dead = [&](ValueId id) { return id < dead.size() && dead[id]; };
+    for (auto id : list)
+      if (is_dead(id)) insts[id].block = kNoBlock;
+    list.erase(std::remove_if(list.begin(), list.end(), is_dead), list.end());
+  }
+}
+
+void Function::remove_block(BlockId bb) {
+  for (auto inst : blocks[bb].insts) insts[inst].block = kNoBlock;
+  blocks[bb].insts.clear();
+  blocks[bb].removed = true;
+}
+
+int Function::remove_unreachable_blocks() {
+  std::vector<bool> reached(blocks.size(), false);
+  std::vector<BlockId> worklist{0};
+  reached[0] = true;
+  while (!worklist.empty()) {
+    BlockId bb = worklist.back();
+    worklist.pop_back();
+    for (auto succ : succs(bb))
+      if (!reached[succ]) {
+        reached[succ] = true;
+        worklist.push_back(succ);
+      }
+  }
+  int removed = 0;
+  for (BlockId bb = 0; bb < blocks.size(); bb++) {
+    if (reached[bb] || blocks[bb].removed) continue;
+    // 可达的后继块中的 phi 不再有来自这个块的值
+    for (auto succ : succs(bb)) {
+      if (!reached[succ]) continue;
+      for (auto id : blocks[succ].insts) {
+        if (insts[id].op != Opcode::Phi) break;
+        remove_incoming(id, bb);
+      }
+    }
+    remove_block(bb);
+    removed++;
+  }
+  return removed;
+}
+
+ValueId Function::terminator(BlockId bb) const {
+  auto &list = blocks[bb].insts;
+  if (list.empty() || !is_terminator(insts[list.back()].op)) return kNoValue;
+  return list.back();
+}
+
+std::vector<BlockId> Function::succs(BlockId bb) const {
+  ValueId term = terminator(bb);
+  if (term == kNoValue) return {};
+  auto &inst = insts[term];
+  return std::vector<BlockId>(inst.targets, inst.targets + inst.num_targets);
+}
+
+void Function::replace_target(ValueId term, BlockId from, BlockId to) {
+  auto &inst = insts[term];
+  for (uint32_t i = 0; i < inst.num_targets; i++)
+    if (inst.targets[i] == from) inst.targets[i] = to;
+}
+
+void Function::replace_all_uses(ValueId from, ValueId to) {
+  for (auto &block : blocks)
+    for (auto id : block.insts) {
+      auto &inst = insts[id];
+      for (uint32_t i = 0; i < inst.num_ops; i++)
+        if (inst.ops[i] == from) inst.ops[i] = to;
+    }
+}
+
+bool Function::has_side_effects(ValueId v) const {
+  auto op = insts[v].op;
+  return op == Opcode::Store || op == Opcode::Call || is_terminator(op);
+}
+
+std::string Function::value_name(ValueId v, const Module &module) const {
+  auto &inst = insts[v];
+  switch (inst.op) {
+    case Opcode::Const: return std::to_string(inst.imm);
+    case Opcode::Arg: return "%arg" + std::to_string(inst.imm);
+    case Opcode::Global: return "@" + module.globals[inst.imm].name;
+    case Opcode::Undef: return "undef";
+    default: break;
+  }
+  auto it = names.find(v);
+  if (it != names.end()) return "%" + it->second;
+  return "%" + std::to_string(v);
+}
+
+static std::string block_name(BlockId bb) { return "bb" + std::to_string(bb); }
+
+void Function::print(std::ostream &os, const Module &module) const {
+  os << (is_external ? "declare " : "define ") << type_to_string(ret_type)
+     << " @" << name << "(";
+  for (size_t i = 0; i < args.size(); i++) {
+    if (i) os << ", ";
+    os << type_to_string(param_types[i]);
+    if (!is_external) os << " " << value_name(args[i], module);
+  }
+  os << ")";
+  if (is_external) {
+    os << "\n";
+    return;
+  }
+  os << " {\n";
+  for (BlockId bb = 0; bb < blocks.size(); bb++) {
+    if (blocks[bb].removed) continue;
+    os << block_name(bb) << ":\n";
+    for (auto id : blocks[bb].insts) {
+      auto &inst = insts[id];
+      auto ops = [&](uint32_t from) {
+        std::string res;
+        for (uint32_t i = from; i < inst.num_ops; i++)
+          res += (i > from ? ", " : "") + value_name(inst.ops[i], module);
+        return res;
+      };
+      os << "  ";
+      if (inst.type != Type::Void) os << value_name(id, module) << " = ";
+      if (inst.op == Opcode::Call && (inst.flags & kCallTail)) os << "tail ";
+      os << opcode_to_string(inst.op);
+      switch (inst.op) {
+        case Opcode::Alloca:
+          os << " [" << inst.imm << " x i32]";
+          break;
+        case Opcode::Call:
+          os << " " << type_to_string(inst.type) << " @"
+             << module.functions[inst.imm]->name << "(" << ops(0) << ")";
+          break;
+        case Opcode::Phi:
+          os << " " << type_to_string(inst.type);
+          for (uint32_t i = 0; i < inst.num_ops; i++)
+            os << (i ? ", [" : " [") << value_name(inst.ops[i], module)
+               << ", " << block_name(inst.targets[i]) << "]";
+          break;
+        case Opcode::Br:
+          os << " " << block_name(inst.targets[0]);
+          break;
+        case Opcode::CondBr:
+          os << " " << ops(0) << ", " << block_name(inst.targets[0]) << ", "
+             << block_name(inst.targets[1]);
+          break;
+        case Opcode::Ret:
+          os << " " << (inst.num_ops ? ops(0) : "void");
+          break;
+        default:
+          if (inst.type != Type::Void) os << " " << type_to_string(inst.type);
+          os << " " << ops(0);
+          break;
+      }
+      os << "\n";
+    }
+  }
+  os << "}\n";
+}
+
+int Module::add_function(FunctionPtr func) {
+  functions.push_back(func);
+  return functions.size() - 1;
+}
+
+int Module::find_function(const std::string &name) const {
+  for (size_t i = 0; i < functions.size(); i++)
+    if (functions[i]->name == name) return i;
+  return -1;
+}
+
+void Module::remove_functions(const std::vector<bool> &dead) {
+  std::vector<int> index(functions.size(), -1);
+  std::vector<FunctionPtr> kept;
+  for (size_t i = 0; i < functions.size(); i++) {
+    if (dead[i]) continue;
+    index[i] = kept.size();
+    kept.push_back(functions[i]);
+  }
+  for (auto &func : kept)
+    for (auto &block : func->blocks)
+      for (auto id : block.insts) {
+        auto &inst = (*func)[id];
+        if (inst.op != Opcode::Call) continue;
+        ASSERT(index[inst.imm] >= 0, "Call to a deleted function");
+        inst.imm = index[inst.imm];
+      }
+  functions.swap(kept);
+}
+
+int Module::add_global(Global global) {
+  globals.push_back(global);
+  return globals.size() - 1;
+}
+
+void Module::print(std::ostream &os) const {
+  for (auto &global : globals) {
+    os << "@" << global.name << " = "
+       << (global.is_const ? "constant " : "global ");
+    if (global.is_array)
+      os << "[" << global.size << " x i32] ";
+    else
+      os << "i32 ";
+    if (!global.init || global.init->runs.empty()) {
+      os << (global.is_array ? "zeroinitializer" : "0") << "\n";
+      continue;
+    }
+    if (!global.is_array) {
+      os << global.init->runs[0].elems[0].value << "\n";
+      continue;
+    }
+    // 稀疏地输出非零的元素段：{[offset] = v0, v1, ...}
+    os << "{";
+    bool first = true;
+    for (auto &run : global.init->runs) {
+      os << (first ? "" : ", ") << "[" << run.offset << "] = ";
+      for (size_t i = 0; i < run.elems.size(); i++)
+        os << (i ? ", " : "") << run.elems[i].value;
+      first = false;
+    }
+    os << "}\n";
+  }
+  if (!globals.empty()) os << "\n";
+  for (auto &func : functions) {
+    func->print(os, *this);
+    if (!func->is_external) os << "\n";
+  }
+}
+
+}  // namespace IR
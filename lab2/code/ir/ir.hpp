@@ -0,0 +1,260 @@
+#ifndef IR_IR_HPP
+#define IR_IR_HPP
+
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common.hpp"
+#include "ir/arena.hpp"
+#include "semantic/initializer.hpp"
+
+namespace IR {
+
+/// @brief Index of a value in Function::insts
+using ValueId = uint32_t;
+/// @brief Index of a basic block in Function::blocks
+using BlockId = uint32_t;
+
+class Module;
+
+constexpr ValueId kNoValue = UINT32_MAX;
+constexpr BlockId kNoBlock = UINT32_MAX;
+
+enum class Type : uint8_t { Void, I32, Ptr };
+const char *type_to_string(Type type);
+
+enum class Opcode : uint8_t {
+  // 不属于任何基本块的值
+  Const,   // imm: the value
+  Arg,     // imm: the index of the parameter
+  Global,  // imm: the index of the global in Module::globals
+  Undef,
+  // i32 运算，比较的结果为 0 或 1
+  Add, Sub, Mul, Div, Mod,
+  MulHi,   // the high 32 bits of the signed 64-bit product
+  Shl, AShr, LShr,  // shift amounts are taken modulo 32
+  Lt, Le, Gt, Ge, Eq, Ne,
+  Select,  // ops: cond, the value if cond != 0, the value otherwise
+  // 内存
+  Alloca,  // imm: the number of i32 slots
+  Load,    // ops: ptr
+  Store,   // ops: value, ptr
+  Gep,     // ops: base, index; the address of base[index]
+  Call,    // imm: the index of the callee in Module::functions, ops: args
+  Phi,     // ops[i] flows in from targets[i]
+  // 终结指令
+  Br,      // targets: dest
+  CondBr,  // ops: cond; targets: the dest if cond != 0, the dest otherwise
+  Ret,     // ops: the optional return value
+};
+const char *opcode_to_string(Opcode op);
+
+/// @brief Values that are not placed in a basic block
+inline bool is_floating(Opcode op) { return op <= Opcode::Undef; }
+inline bool is_binary(Opcode op) {
+  return op >= Opcode::Add && op <= Opcode::Ne;
+}
+inline bool is_compare(Opcode op) {
+  return op >= Opcode::Lt && op <= Opcode::Ne;
+}
+inline bool is_commutative(Opcode op) {
+  return op == Opcode::Add || op == Opcode::Mul || op == Opcode::MulHi ||
+         op == Opcode::Eq || op == Opcode::Ne;
+}
+inline bool is_terminator(Opcode op) { return op >= Opcode::Br; }
+/// @brief The compare giving the same result with the operands swapped
+inline Opcode swap_compare(Opcode op) {
+  switch (op) {
+    case Opcode::Lt: return Opcode::Gt;
+    case Opcode::Gt: return Opcode::Lt;
+    case Opcode::Le: return Opcode::Ge;
+    case Opcode::Ge: return Opcode::Le;
+    default: return op;
+  }
+}
+
+/// @brief The IR opcode of an arithmetic or comparison BinaryOp
+Opcode from_binary_op(BinaryOp op);
+/// @brief The BinaryOp computed by a binary opcode
+BinaryOp to_binary_op(Opcode op);
+/// @brief Evaluate a binary opcode on constants
+/// @return nullopt on division by zero
+std::optional<int> eval_binary(Opcode op, int lhs, int rhs);
+
+/// @brief Inst::flags of a call whose callee neither reads nor writes
+/// memory of the caller, e.g. the runtime functions `read` and `write`
+constexpr uint8_t kCallNoMemory = 1 << 0;
+/// @brief Inst::flags of a call whose result is returned right away and
+/// whose arguments do not point into the caller's frame, so the callee may
+/// reuse that frame
+constexpr uint8_t kCallTail = 1 << 1;
+
+/// @brief One SSA value. Operand and target lists live in the arena of the
+/// owning function, so an instruction is a small fixed-size record.
+struct Inst {
+  Opcode op;
+  Type type;
+  /// @brief Opcode-specific flags
+  uint8_t flags = 0;
+  /// @brief The owning block, kNoBlock for floating or detached values
+  BlockId block = kNoBlock;
+  int32_t imm = 0;
+  uint32_t num_ops = 0;
+  uint32_t num_targets = 0;
+  uint32_t capacity = 0;
+  ValueId *ops = nullptr;
+  BlockId *targets = nullptr;
+
+  ValueId operand(size_t i) const { return ops[i]; }
+  BlockId target(size_t i) const { return targets[i]; }
+};
+
+struct Block {
+  /// @brief Instructions in order: phis first, the terminator last
+  std::vector<ValueId> insts;
+  /// @brief Whether the block has been deleted
+  bool removed = false;
+};
+
+class Function;
+using FunctionPtr = std::shared_ptr<Function>;
+class Function {
+ public:
+  std::string name;
+  Type ret_type;
+  std::vector<Type> param_types;
+  /// @brief Declared only, e.g. the runtime functions `read` and `write`
+  bool is_external;
+  /// @brief The Arg value of each parameter
+  std::vector<ValueId> args;
+  /// @brief Every value of the function, indexed by ValueId
+  std::vector<Inst> insts;
+  /// @brief Basic blocks indexed by BlockId, blocks[0] is the entry
+  std::vector<Block> blocks;
+  /// @brief Source names of stack slots, used by the printer
+  std::unordered_map<ValueId, std::string> names;
+  Arena arena;
+
+  Function(std::string name, Type ret_type, std::vector<Type> param_types,
+           bool is_external = false);
+
+  static FunctionPtr create(std::string name, Type ret_type,
+                            std::vector<Type> param_types,
+                            bool is_external = false) {
+    return std::make_shared<Function>(name, ret_type, param_types,
+                                      is_external);
+  }
+
+  Inst &operator[](ValueId id) { return insts[id]; }
+  const Inst &operator[](ValueId id) const { return insts[id]; }
+
+  /// @brief The uniqued constant `value`
+  ValueId const_int(int value);
+  /// @brief The uniqued undefined value of `type`
+  ValueId undef(Type type = Type::I32);
+  /// @brief The uniqued address of global `index`
+  ValueId global_addr(int index);
+  bool is_const(ValueId v) const { return insts[v].op == Opcode::Const; }
+
+  /// @brief Create a detached instruction
+  ValueId create(Opcode op, Type type, const std::vector<ValueId> &ops = {},
+                 const std::vector<BlockId> &targets = {}, int32_t imm = 0);
+
+  void set_operand(ValueId inst, size_t i, ValueId value) {
+    insts[inst].ops[i] = value;
+  }
+  /// @brief Add an incoming value to a phi
+  void add_incoming(ValueId phi, ValueId value, BlockId from);
+  /// @brief Remove the incoming values of a phi from block `from`
+  void remove_incoming(ValueId phi, BlockId from);
+  /// @brief The incoming value of a phi from block `from`
+  ValueId incoming(ValueId phi, BlockId from) const;
+  /// @brief Make the phis of `bb` take their values from `from` from `to`
+  /// instead
+  void replace_incoming_block(BlockId bb, BlockId from, BlockId to);
+
+  BlockId add_block();
+  size_t num_blocks() const { return blocks.size(); }
+  /// @brief Append `inst` at the end of `bb`
+  void append(BlockId bb, ValueId inst);
+  /// @brief Insert `inst` in front of `pos`
+  void insert_before(ValueId pos, ValueId inst);
+  /// @brief Insert `inst` in front of the terminator of `bb`
+  void insert_before_terminator(BlockId bb, ValueId inst);
+  /// @brief Insert `inst` after the phis of `bb`
+  void insert_after_phis(BlockId bb, ValueId inst);
+  /// @brief Remove `inst` from its block, it may be placed again later
+  void detach(ValueId inst);
+  /// @brief Remove the instructions with dead[id] set from their blocks
+  void remove_insts(const std::vector<bool> &dead);
+  /// @brief Delete a block and all of its instructions
+  void remove_block(BlockId bb);
+  /// @brief Delete the blocks that cannot be reached from the entry and
+  /// drop their phi incomings
+  /// @return the number of deleted blocks
+  int remove_unreachable_blocks();
+
+  /// @brief The terminator of `bb`, kNoValue if the block is unterminated
+  ValueId terminator(BlockId bb) const;
+  /// @brief The successors of `bb` in terminator order
+  std::vector<BlockId> succs(BlockId bb) const;
+  /// @brief Redirect the edges of a terminator from `from` to `to`
+  void replace_target(ValueId term, BlockId from, BlockId to);
+  /// @brief Replace every use of `from` by `to`
+  void replace_all_uses(ValueId from, ValueId to);
+
+  /// @brief Whether the instruction has effects other than its result
+  bool has_side_effects(ValueId v) const;
+
+  void print(std::ostream &os, const Module &module) const;
+  std::string value_name(ValueId v, const Module &module) const;
+
+ private:
+  std::unordered_map<int, ValueId> consts;
+  std::unordered_map<int, ValueId> globals;
+  std::unordered_map<int, ValueId> undefs;
+
+  ValueId new_value(Opcode op, Type type, int32_t imm);
+  void grow(Inst &inst, uint32_t capacity);
+};
+
+struct Global {
+  std::string name;
+  /// @brief The number of i32 elements
+  int64_t size;
+  bool is_array;
+  bool is_const;
+  /// @brief The initial contents, all elements are constants
+  InitImagePtr init;
+};
+
+class Module;
+using ModulePtr = std::shared_ptr<Module>;
+class Module {
+ public:
+  std::vector<FunctionPtr> functions;
+  std::vector<Global> globals;
+
+  static ModulePtr create() { return std::make_shared<Module>(); }
+
+  /// @brief Add a function and return its index
+  int add_function(FunctionPtr func);
+  /// @brief The index of function `name`, -1 if absent
+  int find_function(const std::string &name) const;
+  /// @brief Delete the functions with dead[index] set and renumber the
+  /// callees of the remaining calls
+  void remove_functions(const std::vector<bool> &dead);
+  int add_global(Global global);
+
+  void print(std::ostream &os) const;
+};
+
+}  // namespace IR
+
+#endif  // IR_IR_HPP
@@ -0,0 +1,376 @@
+#include "ir_gen.hpp"
+
+using namespace IR;
+
+/// @brief Arrays up to this size are zero-filled by straight-line stores
+static constexpr int64_t kMaxInlineFill = 16;
+
+static IR::Type param_type(AST::FuncFParamPtr param) {
+  return param->is_arr ? IR::Type::Ptr : IR::Type::I32;
+}
+
+ModulePtr IRGenerator::generate(AST::NodePtr root) {
+  module = Module::create();
+  // 运行时库函数
+  module->add_function(Function::create("read", IR::Type::I32, {}, true));
+  module->add_function(Function::create("write", IR::Type::Void, {IR::Type::I32}, true));
+  genCompUnit(std::dynamic_pointer_cast<AST::CompUnit>(root));
+  return module;
+}
+
+void IRGenerator::genCompUnit(AST::CompUnitPtr node) {
+  ASSERT(node, "IR generation expects a CompUnit");
+  for (auto &unit : node->units) {
+    if (auto n = std::dynamic_pointer_cast<AST::FuncDef>(unit))
+      genFuncDef(n);
+    else
+      genGlobalDecl(unit);
+  }
+}
+
+void IRGenerator::genGlobalDecl(AST::NodePtr node) {
+  if (auto decl = std::dynamic_pointer_cast<AST::VarDecl>(node)) {
+    for (auto &def : decl->defs) {
+      // 类型检查已经把全局变量的初始值求出来了
+      auto init = InitImage::create(1);
+      if (def->symbol->const_value)
+        init->append(0, InitElem::constant(def->symbol->const_value));
+      globals[def->symbol->unique_name] = module->add_global(
+          Global{def->ident, 1, false, decl->is_const, init});
+    }
+  } else if (auto decl = std::dynamic_pointer_cast<AST::ArrDecl>(node)) {
+    for (auto &def : decl->defs) {
+      auto size = def->symbol->layout->size;
+      auto init = def->image ? def->image : InitImage::create(size);
+      globals[def->symbol->unique_name] =
+          module->add_global(Global{def->ident, size, true, decl->is_const, init});
+    }
+  } else {
+    ASSERT(false, "Unknown global declaration " + node->to_string());
+  }
+}
+
+void IRGenerator::genFuncDef(AST::FuncDefPtr node) {
+  std::vector<IR::Type> param_types;
+  if (node->is_param)
+    for (auto &param : node->params->args)
+      param_types.push_back(param_type(param));
+  auto ret_type = node->return_btype == BasicType::Int ? IR::Type::I32 : IR::Type::Void;
+  func = Function::create(node->name, ret_type, param_types);
+  module->add_function(func);
+  locals.clear();
+  num_allocas = 0;
+  cur = func->add_block();
+
+  // 标量参数先放进栈槽，数组参数直接使用传入的指针
+  if (node->is_param)
+    for (size_t i = 0; i < node->params->args.size(); i++) {
+      auto &param = node->params->args[i];
+      auto &name = param->symbol->unique_name;
+      if (param->is_arr) {
+        locals[name] = func->args[i];
+      } else {
+        auto slot = emitAlloca(1, name);
+        emit(Opcode::Store, IR::Type::Void, {func->args[i], slot});
+        locals[name] = slot;
+      }
+    }
+
+  genBlock(node->block);
+  // 没有 return 的函数末尾补上返回指令
+  if (!terminated()) {
+    if (ret_type == IR::Type::Void)
+      emit(Opcode::Ret, IR::Type::Void);
+    else
+      emit(Opcode::Ret, IR::Type::Void, {func->const_int(0)});
+  }
+  func = nullptr;
+}
+
+void IRGenerator::genStmt(AST::NodePtr node) {
+  if (auto n = std::dynamic_pointer_cast<AST::Block>(node))
+    genBlock(n);
+  else if (auto n = std::dynamic_pointer_cast<AST::VarDecl>(node))
+    genVarDecl(n);
+  else if (auto n = std::dynamic_pointer_cast<AST::ArrDecl>(node))
+    genArrDecl(n);
+  else if (auto n = std::dynamic_pointer_cast<AST::AssignStmt>(node))
+    genAssignStmt(n);
+  else if (auto n = std::dynamic_pointer_cast<AST::ReturnStmt>(node))
+    genReturnStmt(n);
+  else if (auto n = std::dynamic_pointer_cast<AST::IfStmt>(node))
+    genIfStmt(n);
+  else if (auto n = std::dynamic_pointer_cast<AST::WhileStmt>(node))
+    genWhileStmt(n);
+  else if (type_of<AST::NullStmt>(node))
+    return;
+  else
+    genExp(node);  // 表达式语句
+}
+
+void IRGenerator::genBlock(AST::BlockPtr node) {
+  for (auto &stmt : node->stmts) {
+    genStmt(stmt);
+    // return 之后的语句执行不到，不再生成
+    if (terminated()) break;
+  }
+}
+
+void IRGenerator::genVarDecl(AST::VarDeclPtr node) {
+  for (auto &def : node->defs) {
+    auto slot = emitAlloca(1, def->symbol->unique_name);
+    locals[def->symbol->unique_name] = slot;
+    if (!def->val.has_value()) continue;
+    auto init = std::dynamic_pointer_cast<AST::InitVal>(def->val.value());
+    emit(Opcode::Store, IR::Type::Void, {genExp(init->args[0]), slot});
+  }
+}
+
+void IRGenerator::genArrDecl(AST::ArrDeclPtr node) {
+  for (auto &def : node->defs) {
+    auto base = emitAlloca(def->symbol->layout->size, def->symbol->unique_name);
+    locals[def->symbol->unique_name] = base;
+    if (def->image) emitArrayInit(base, *def->image);
+  }
+}
+
+void IRGenerator::emitArrayInit(ValueId base, const InitImage &image) {
+  if (image.count() < image.size) {
+    if (image.size <= kMaxInlineFill) {
+      // 小数组只给没有显式初始化的元素逐个写零
+      int64_t pos = 0;
+      auto fill_to = [&](int64_t end) {
+        for (; pos < end; pos++) {
+          auto addr = emit(Opcode::Gep, IR::Type::Ptr, {base, func->const_int(pos)});
+          emit(Opcode::Store, IR::Type::Void, {func->const_int(0), addr});
+        }
+      };
+      for (auto &run : image.runs) {
+        fill_to(run.offset);
+        pos = run.end();
+      }
+      fill_to(image.size);
+    } else {
+      // for (i = 0; i < size; i++) base[i] = 0;
+      BlockId pre = cur, loop = func->add_block(), exit = func->add_block();
+      emitBr(loop);
+      cur = loop;
+      auto i = func->create(Opcode::Phi, IR::Type::I32);
+      func->append(loop, i);
+      func->add_incoming(i, func->const_int(0), pre);
+      auto addr = emit(Opcode::Gep, IR::Type::Ptr, {base, i});
+      emit(Opcode::Store, IR::Type::Void, {func->const_int(0), addr});
+      auto next = emit(Opcode::Add, IR::Type::I32, {i, func->const_int(1)});
+      func->add_incoming(i, next, loop);
+      auto cond = emit(Opcode::Lt, IR::Type::I32, {next, func->const_int(image.size)});
+      emit(Opcode::CondBr, IR::Type::Void, {cond}, {loop, exit});
+      cur = exit;
+    }
+  }
+  for (auto &run : image.runs)
+    for (size_t i = 0; i < run.elems.size(); i++) {
+      auto &elem = run.elems[i];
+      auto value = elem.is_const ? func->const_int(elem.value) : genExp(elem.exp);
+      auto addr = emit(Opcode::Gep, IR::Type::Ptr, {base, func->const_int(run.offset + i)});
+      emit(Opcode::Store, IR::Type::Void, {value, addr});
+    }
+}
+
+void IRGenerator::genAssignStmt(AST::AssignStmtPtr node) {
+  auto value = genExp(node->exp);
+  auto addr = genAddr(node->lval);
+  emit(Opcode::Store, IR::Type::Void, {value, addr});
+}
+
+void IRGenerator::genReturnStmt(AST::ReturnStmtPtr node) {
+  if (node->is_void)
+    emit(Opcode::Ret, IR::Type::Void);
+  else
+    emit(Opcode::Ret, IR::Type::Void, {genExp(node->exp)});
+}
+
+void IRGenerator::genIfStmt(AST::IfStmtPtr node) {
+  BlockId then_bb = func->add_block(), end_bb = func->add_block();
+  BlockId else_bb = node->else_stmt ? func->add_block() : end_bb;
+  genCond(node->cond, then_bb, else_bb);
+  cur = then_bb;
+  genStmt(node->stmt);
+  emitBr(end_bb);
+  if (node->else_stmt) {
+    cur = else_bb;
+    genStmt(node->else_stmt);
+    emitBr(end_bb);
+  }
+  cur = end_bb;
+}
+
+void IRGenerator::genWhileStmt(AST::WhileStmtPtr node) {
+  BlockId cond_bb = func->add_block(), body_bb = func->add_block(),
+          end_bb = func->add_block();
+  emitBr(cond_bb);
+  cur = cond_bb;
+  genCond(node->cond, body_bb, end_bb);
+  cur = body_bb;
+  genStmt(node->stmt);
+  emitBr(cond_bb);
+  cur = end_bb;
+}
+
+ValueId IRGenerator::genExp(AST::NodePtr node) {
+  if (auto n = std::dynamic_pointer_cast<AST::IntConst>(node))
+    return func->const_int(n->value);
+  if (auto n = std::dynamic_pointer_cast<AST::LVal>(node)) return genLVal(n);
+  if (auto n = std::dynamic_pointer_cast<AST::UnaryExp>(node))
+    return genUnaryExp(n);
+  if (auto n = std::dynamic_pointer_cast<AST::BinaryExp>(node))
+    return genBinaryExp(n);
+  if (auto n = std::dynamic_pointer_cast<AST::FuncCall>(node))
+    return genFuncCall(n);
+  ASSERT(false, "Unknown expression " + node->to_string() + " at line " +
+                    std::to_string(node->lineno));
+  return kNoValue;
+}
+
+ValueId IRGenerator::genLVal(AST::LValPtr node) {
+  auto addr = genAddr(node);
+  // 下标不足的数组作为指针使用
+  auto &layout = node->symbol->layout;
+  if (layout) {
+    size_t indexed = node->is_arr
+        ? std::dynamic_pointer_cast<AST::ExpList>(node->index)->args.size() : 0;
+    if (indexed < layout->rank()) return addr;
+  }
+  return emit(Opcode::Load, IR::Type::I32, {addr});
+}
+
+ValueId IRGenerator::genAddr(AST::LValPtr node) {
+  auto &symbol = node->symbol;
+  ValueId base;
+  auto it = locals.find(symbol->unique_name);
+  if (it != locals.end()) {
+    base = it->second;
+  } else {
+    auto git = globals.find(symbol->unique_name);
+    ASSERT(git != globals.end(), "No storage for " + symbol->name);
+    base = func->global_addr(git->second);
+  }
+  if (!node->is_arr) return base;
+
+  // 按行主序把多维下标展开成一维偏移
+  auto &layout = symbol->layout;
+  auto index = std::dynamic_pointer_cast<AST::ExpList>(node->index);
+  ValueId offset = kNoValue;
+  for (size_t k = 0; k < index->args.size(); k++) {
+    auto term = genExp(index->args[k]);
+    if (layout->strides[k] != 1)
+      term = emitBinary(Opcode::Mul, term, func->const_int(layout->strides[k]));
+    offset = offset == kNoValue ? term : emitBinary(Opcode::Add, offset, term);
+  }
+  return emit(Opcode::Gep, IR::Type::Ptr, {base, offset});
+}
+
+ValueId IRGenerator::genUnaryExp(AST::UnaryExpPtr node) {
+  auto value = genExp(node->exp);
+  switch (node->op) {
+    case BinaryOp::Add: return value;
+    case BinaryOp::Sub: return emitBinary(Opcode::Sub, func->const_int(0), value);
+    case BinaryOp::Not: return emitBinary(Opcode::Eq, value, func->const_int(0));
+    default: break;
+  }
+  ASSERT(false, "Unknown unary operator " + node->to_string());
+  return kNoValue;
+}
+
+ValueId IRGenerator::genBinaryExp(AST::BinaryExpPtr node) {
+  if (node->op == BinaryOp::And || node->op == BinaryOp::Or)
+    return genLogicExp(node);
+  auto lhs = genExp(node->left);
+  auto rhs = genExp(node->right);
+  return emitBinary(from_binary_op(node->op), lhs, rhs);
+}
+
+ValueId IRGenerator::genLogicExp(AST::BinaryExpPtr node) {
+  // 只有作为值使用时才需要 0/1，两条出路在汇合处用 phi 选出
+  BlockId true_bb = func->add_block(), false_bb = func->add_block(),
+          end_bb = func->add_block();
+  genCond(node, true_bb, false_bb);
+  cur = true_bb;
+  emitBr(end_bb);
+  cur = false_bb;
+  emitBr(end_bb);
+  cur = end_bb;
+  auto phi = func->create(Opcode::Phi, IR::Type::I32);
+  func->append(end_bb, phi);
+  func->add_incoming(phi, func->const_int(1), true_bb);
+  func->add_incoming(phi, func->const_int(0), false_bb);
+  return phi;
+}
+
+void IRGenerator::genCond(AST::NodePtr node, BlockId true_bb,
+                          BlockId false_bb) {
+  if (auto n = std::dynamic_pointer_cast<AST::BinaryExp>(node)) {
+    // a && b：a 为假直接跳到假出口，a || b：a 为真直接跳到真出口
+    if (n->op == BinaryOp::And || n->op == BinaryOp::Or) {
+      BlockId rhs_bb = func->add_block();
+      if (n->op == BinaryOp::And)
+        genCond(n->left, rhs_bb, false_bb);
+      else
+        genCond(n->left, true_bb, rhs_bb);
+      cur = rhs_bb;
+      genCond(n->right, true_bb, false_bb);
+      return;
+    }
+  }
+  if (auto n = std::dynamic_pointer_cast<AST::UnaryExp>(node)) {
+    // -x 与 x 同时为零
+    if (n->op == BinaryOp::Not) return genCond(n->exp, false_bb, true_bb);
+    return genCond(n->exp, true_bb, false_bb);
+  }
+  // 比较的结果直接用于跳转，其他值按非零为真
+  auto cond = genExp(node);
+  emit(Opcode::CondBr, IR::Type::Void, {cond}, {true_bb, false_bb});
+}
+
+ValueId IRGenerator::genFuncCall(AST::FuncCallPtr node) {
+  int callee = module->find_function(node->name);
+  ASSERT(callee >= 0, "Call to unknown function " + node->name);
+  std::vector<ValueId> args;
+  for (auto &arg : node->args) args.push_back(genExp(arg));
+  auto &decl = *module->functions[callee];
+  auto call = emit(Opcode::Call, decl.ret_type, args, {}, callee);
+  // 运行时函数只做输入输出，不会访问调用者的内存
+  if (decl.is_external) (*func)[call].flags |= IR::kCallNoMemory;
+  return call;
+}
+
+ValueId IRGenerator::emit(Opcode op, IR::Type type, const std::vector<ValueId> &ops,
+                          const std::vector<BlockId> &targets, int32_t imm) {
+  auto inst = func->create(op, type, ops, targets, imm);
+  func->append(cur, inst);
+  return inst;
+}
+
+ValueId IRGenerator::emitBinary(Opcode op, ValueId lhs, ValueId rhs) {
+  if (func->is_const(lhs) && func->is_const(rhs))
+    if (auto val = eval_binary(op, (*func)[lhs].imm, (*func)[rhs].imm))
+      return func->const_int(*val);
+  return emit(op, IR::Type::I32, {lhs, rhs});
+}
+
+ValueId IRGenerator::emitAlloca(int64_t size, const std::string &name) {
+  // 所有栈槽都放在入口块的开头
+  auto slot = func->create(Opcode::Alloca, IR::Type::Ptr, {}, {}, size);
+  auto &entry = func->blocks[0].insts;
+  entry.insert(entry.begin() + num_allocas++, slot);
+  (*func)[slot].block = 0;
+  func->names[slot] = name;
+  return slot;
+}
+
+void IRGenerator::emitBr(BlockId dest) {
+  if (!terminated()) emit(Opcode::Br, IR::Type::Void, {}, {dest});
+}
+
+bool IRGenerator::terminated() const {
+  return func->terminator(cur) != kNoValue;
+}
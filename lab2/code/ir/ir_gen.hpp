@@ -0,0 +1,72 @@
+#ifndef IR_IR_GEN_HPP
+#define IR_IR_GEN_HPP
+
+#include <string>
+#include <unordered_map>
+
+#include "ast/tree.hpp"
+#include "ir/ir.hpp"
+
+/// @brief Lowers a type-checked AST to IR. Every scalar variable lives in
+/// a stack slot (or a global), arrays are addressed through `gep` on a
+/// flattened row-major index, and conditions become chains of branches
+/// so that `&&`/`||` only evaluate their right operand when needed.
+class IRGenerator {
+ public:
+  IR::ModulePtr generate(AST::NodePtr root);
+
+ private:
+  IR::ModulePtr module;
+  IR::FunctionPtr func;
+  /// @brief The block new instructions are appended to
+  IR::BlockId cur = IR::kNoBlock;
+  /// @brief The number of allocas at the start of the entry block
+  size_t num_allocas = 0;
+  /// @brief The address of each local variable, keyed by Symbol::unique_name
+  std::unordered_map<std::string, IR::ValueId> locals;
+  /// @brief The global index of each global variable, keyed by
+  /// Symbol::unique_name
+  std::unordered_map<std::string, int> globals;
+
+  void genCompUnit(AST::CompUnitPtr node);
+  void genGlobalDecl(AST::NodePtr node);
+  void genFuncDef(AST::FuncDefPtr node);
+
+  void genStmt(AST::NodePtr node);
+  void genBlock(AST::BlockPtr node);
+  void genVarDecl(AST::VarDeclPtr node);
+  void genArrDecl(AST::ArrDeclPtr node);
+  void genAssignStmt(AST::AssignStmtPtr node);
+  void genReturnStmt(AST::ReturnStmtPtr node);
+  void genIfStmt(AST::IfStmtPtr node);
+  void genWhileStmt(AST::WhileStmtPtr node);
+
+  IR::ValueId genExp(AST::NodePtr node);
+  IR::ValueId genLVal(AST::LValPtr node);
+  IR::ValueId genAddr(AST::LValPtr node);
+  IR::ValueId genUnaryExp(AST::UnaryExpPtr node);
+  IR::ValueId genBinaryExp(AST::BinaryExpPtr node);
+  /// @brief Materialize `&&`/`||` as 0 or 1
+  IR::ValueId genLogicExp(AST::BinaryExpPtr node);
+  /// @brief Branch to `true_bb` if `node` is non-zero, else to `false_bb`
+  void genCond(AST::NodePtr node, IR::BlockId true_bb, IR::BlockId false_bb);
+  IR::ValueId genFuncCall(AST::FuncCallPtr node);
+
+  /// @brief Append a new instruction to the current block
+  IR::ValueId emit(IR::Opcode op, IR::Type type,
+                   const std::vector<IR::ValueId> &ops = {},
+                   const std::vector<IR::BlockId> &targets = {},
+                   int32_t imm = 0);
+  /// @brief Emit a binary operation, folding it if both operands are
+  /// constants
+  IR::ValueId emitBinary(IR::Opcode op, IR::ValueId lhs, IR::ValueId rhs);
+  /// @brief Emit a stack slot of `size` elements in the entry block
+  IR::ValueId emitAlloca(int64_t size, const std::string &name);
+  /// @brief Store the initializer image of an array starting at `base`
+  void emitArrayInit(IR::ValueId base, const InitImage &image);
+  void emitBr(IR::BlockId dest);
+  /// @brief Whether the current block already ends with a terminator
+  bool terminated() const;
+};
+
+#endif  // IR_IR_GEN_HPP
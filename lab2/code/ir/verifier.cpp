@@ -0,0 +1,217 @@
+#include "verifier.hpp"
+
+#include <algorithm>
+
+#include "analysis/dominators.hpp"
+
+namespace IR {
+
+bool Verifier::verify(const Module &module) {
+  errors.clear();
+  for (auto &func : module.functions) {
+    std::vector<std::string> saved;
+    saved.swap(errors);
+    verify(module, *func);
+    saved.insert(saved.end(), errors.begin(), errors.end());
+    errors.swap(saved);
+  }
+  return errors.empty();
+}
+
+bool Verifier::verify(const Module &module, const Function &func) {
+  errors.clear();
+  this->module = &module;
+  this->func = &func;
+  if (func.is_external) return true;
+  if (func.blocks.empty() || func.blocks[0].removed) {
+    error(kNoValue, "function has no entry block");
+    return false;
+  }
+
+  std::vector<std::vector<BlockId>> preds(func.blocks.size());
+  for (BlockId bb = 0; bb < func.blocks.size(); bb++) {
+    if (func.blocks[bb].removed) continue;
+    for (auto succ : func.succs(bb)) {
+      if (succ >= func.blocks.size() || func.blocks[succ].removed) {
+        error(func.terminator(bb), "branch to a missing block");
+        continue;
+      }
+      preds[succ].push_back(bb);
+    }
+  }
+  if (!preds[0].empty()) error(kNoValue, "the entry block has predecessors");
+
+  for (BlockId bb = 0; bb < func.blocks.size(); bb++) {
+    auto &block = func.blocks[bb];
+    if (block.removed) continue;
+    if (func.terminator(bb) == kNoValue) {
+      error(kNoValue, "bb" + std::to_string(bb) + " has no terminator");
+    }
+    bool phis_done = false;
+    for (size_t i = 0; i < block.insts.size(); i++) {
+      ValueId id = block.insts[i];
+      auto &inst = func[id];
+      if (inst.block != bb) error(id, "instruction is not owned by its block");
+      if (is_floating(inst.op)) error(id, "floating value placed in a block");
+      if (is_terminator(inst.op) && i + 1 != block.insts.size())
+        error(id, "terminator in the middle of a block");
+      if (inst.op == Opcode::Phi && phis_done)
+        error(id, "phi after a non-phi instruction");
+      if (inst.op != Opcode::Phi) phis_done = true;
+      verifyInst(id, bb, preds);
+    }
+  }
+
+  // 结构有误时支配关系无从谈起
+  if (errors.empty()) verifyDominance();
+  return errors.empty();
+}
+
+void Verifier::verifyDominance() {
+  CFG cfg(*func);
+  DominatorTree dom(cfg);
+  std::vector<uint32_t> position(func->insts.size(), 0);
+  for (auto &block : func->blocks)
+    for (size_t i = 0; i < block.insts.size(); i++)
+      position[block.insts[i]] = i;
+  // 定义必须支配使用；phi 的值只需支配对应前驱块的末尾
+  auto defined_at = [&](ValueId def, BlockId bb, uint32_t pos) {
+    if (def >= func->insts.size()) return true;
+    auto &inst = func->insts[def];
+    if (is_floating(inst.op) || inst.block == kNoBlock) return true;
+    if (inst.block == bb) return position[def] < pos;
+    return dom.dominates(inst.block, bb);
+  };
+  for (auto bb : cfg.rpo) {
+    auto &block = func->blocks[bb];
+    for (uint32_t i = 0; i < block.insts.size(); i++) {
+      ValueId id = block.insts[i];
+      auto &inst = func->insts[id];
+      for (uint32_t k = 0; k < inst.num_ops; k++) {
+        bool ok = inst.op == Opcode::Phi
+                      ? !cfg.reachable(inst.targets[k]) ||
+                            defined_at(inst.ops[k], inst.targets[k], UINT32_MAX)
+                      : defined_at(inst.ops[k], bb, i);
+        if (!ok)
+          error(id, "operand " + func->value_name(inst.ops[k], *module) +
+                        " does not dominate its use");
+      }
+    }
+  }
+}
+
+void Verifier::verifyInst(ValueId id, BlockId bb,
+                          const std::vector<std::vector<BlockId>> &preds) {
+  auto &inst = func->insts[id];
+  auto expect_ops = [&](uint32_t n) {
+    if (inst.num_ops != n) {
+      error(id, "expects " + std::to_string(n) + " operands");
+      return false;
+    }
+    return true;
+  };
+  switch (inst.op) {
+    case Opcode::Load:
+      if (expect_ops(1)) checkOperand(id, inst.ops[0], Type::Ptr);
+      break;
+    case Opcode::Store:
+      if (expect_ops(2)) {
+        checkOperand(id, inst.ops[0], Type::I32);
+        checkOperand(id, inst.ops[1], Type::Ptr);
+      }
+      break;
+    case Opcode::Gep:
+      if (expect_ops(2)) {
+        checkOperand(id, inst.ops[0], Type::Ptr);
+        checkOperand(id, inst.ops[1], Type::I32);
+      }
+      break;
+    case Opcode::Select:
+      if (inst.type != Type::I32) error(id, "select must produce i32");
+      if (expect_ops(3))
+        for (uint32_t i = 0; i < 3; i++)
+          checkOperand(id, inst.ops[i], Type::I32);
+      break;
+    case Opcode::Alloca:
+      if (inst.imm <= 0) error(id, "alloca of a non-positive size");
+      if (bb != 0) error(id, "alloca outside of the entry block");
+      break;
+    case Opcode::Call: {
+      if (inst.imm < 0 || inst.imm >= (int)module->functions.size()) {
+        error(id, "call to an unknown function");
+        break;
+      }
+      auto &callee = *module->functions[inst.imm];
+      if (inst.type != callee.ret_type) error(id, "call result type mismatch");
+      if (!expect_ops(callee.param_types.size())) break;
+      for (uint32_t i = 0; i < inst.num_ops; i++)
+        checkOperand(id, inst.ops[i], callee.param_types[i]);
+      break;
+    }
+    case Opcode::Phi: {
+      if (inst.num_ops != inst.num_targets)
+        error(id, "phi operand and block counts differ");
+      auto incoming = std::vector<BlockId>(inst.targets, inst.targets + inst.num_targets);
+      auto expected = preds[bb];
+      std::sort(incoming.begin(), incoming.end());
+      std::sort(expected.begin(), expected.end());
+      if (incoming != expected)
+        error(id, "phi incoming blocks do not match the predecessors");
+      for (uint32_t i = 0; i < inst.num_ops; i++)
+        checkOperand(id, inst.ops[i], inst.type);
+      break;
+    }
+    case Opcode::Br:
+      if (inst.num_targets != 1) error(id, "br expects one target");
+      expect_ops(0);
+      break;
+    case Opcode::CondBr:
+      if (inst.num_targets != 2) error(id, "condbr expects two targets");
+      if (expect_ops(1)) checkOperand(id, inst.ops[0], Type::I32);
+      break;
+    case Opcode::Ret:
+      if (func->ret_type == Type::Void) {
+        expect_ops(0);
+      } else if (expect_ops(1)) {
+        checkOperand(id, inst.ops[0], func->ret_type);
+      }
+      break;
+    default:
+      if (is_binary(inst.op)) {
+        if (inst.type != Type::I32) error(id, "arithmetic must produce i32");
+        if (expect_ops(2)) {
+          checkOperand(id, inst.ops[0], Type::I32);
+          checkOperand(id, inst.ops[1], Type::I32);
+        }
+      }
+      break;
+  }
+}
+
+void Verifier::checkOperand(ValueId id, ValueId operand, Type type) {
+  if (operand >= func->insts.size()) {
+    error(id, "operand is not a value");
+    return;
+  }
+  auto &def = func->insts[operand];
+  if (!is_floating(def.op) &&
+      (def.block == kNoBlock || func->blocks[def.block].removed))
+    error(id, "operand " + std::to_string(operand) + " has been deleted");
+  if (def.type != type)
+    error(id, std::string("operand should be ") + type_to_string(type));
+}
+
+void Verifier::error(ValueId id, const std::string &msg) {
+  std::string where = "@" + func->name;
+  if (id != kNoValue) where += ": " + func->value_name(id, *module) + " (" +
+                               opcode_to_string(func->insts[id].op) + ")";
+  errors.push_back(where + ": " + msg);
+}
+
+std::string Verifier::message() const {
+  std::string res;
+  for (auto &err : errors) res += err + "\n";
+  return res;
+}
+
+}  // namespace IR
@@ -0,0 +1,42 @@
+#ifndef IR_VERIFIER_HPP
+#define IR_VERIFIER_HPP
+
+#include <string>
+#include <vector>
+
+#include "ir/ir.hpp"
+
+namespace IR {
+
+/// @brief Checks the structural invariants of the IR: every block ends with
+/// exactly one terminator, phis come first and match the predecessors,
+/// operands are live values of the right type that dominate their uses,
+/// and calls match their callee's signature.
+class Verifier {
+ public:
+  /// @brief All problems found by the last run
+  std::vector<std::string> errors;
+
+  /// @return true if the module is well formed
+  bool verify(const Module &module);
+  bool verify(const Module &module, const Function &func);
+
+  /// @brief The errors joined by newlines
+  std::string message() const;
+
+ private:
+  const Module *module = nullptr;
+  const Function *func = nullptr;
+
+  void verifyInst(ValueId id, BlockId bb,
+                  const std::vector<std::vector<BlockId>> &preds);
+  /// @brief Check that every operand of a reachable instruction is
+  /// defined before it on all paths
+  void verifyDominance();
+  void checkOperand(ValueId id, ValueId operand, Type type);
+  void error(ValueId id, const std::string &msg);
+};
+
+}  // namespace IR
+
+#endif  // IR_VERIFIER_HPP
@@ -5,6 +5,10 @@
 #include <string>
 
 #include "ast/tree.hpp"
+#include "ir/ir_gen.hpp"
+#include "ir/verifier.hpp"
+#include "opt/pass_manager.hpp"
+#include "semantic/const_folder.hpp"
 #include "semantic/type_checker.hpp"
 
 extern int yydebug;  // 0: disable debug mode, 1: enable debug mode
@@ -20,11 +24,16 @@ class Argument {
   std::string output_file;
   bool output_ir = false;
   bool use_venus = false;
+  /// @brief An optimization level such as "O2" or a list of passes
+  std::string pipeline = "O0";
+  bool verify_each = false;
 
   Argument(int argc, char **argv) {
     if (argc < 2) {
       throw std::runtime_error("Usage: " + std::string(argv[0]) +
-                               " <input file> [output file] [--ir] [--venus]");
+                               " <input file> [output file] [--ir] [--venus]"
+                               " [-O0|-O1|-O2] [--passes=<p1,p2,...>]"
+                               " [--verify-each]");
     }
     int pos = 1;
     for (int i = 1; i < argc; i++) {
@@ -32,6 +41,12 @@ class Argument {
         output_ir = true;
       } else if (std::string(argv[i]) == "--venus") {
         use_venus = true;
+      } else if (std::string(argv[i]).rfind("-O", 0) == 0) {
+        pipeline = std::string(argv[i]).substr(1);
+      } else if (std::string(argv[i]).rfind("--passes=", 0) == 0) {
+        pipeline = std::string(argv[i]).substr(9);
+      } else if (std::string(argv[i]) == "--verify-each") {
+        verify_each = true;
       } else if (pos == 1) {
         input_file = argv[i];
         pos++;
@@ -77,6 +92,30 @@ int main(int argc, char **argv) {
       auto type_checker = TypeChecker();
       type_checker.check(root);
       std::cout << "Semantic check passed" << std::endl;
+
+      int removed = ConstFolder().run(root);
+      std::cout << "Constant folding removed " << removed << " AST nodes"
+                << std::endl;
+
+      if (args.output_ir) {
+        auto module = IRGenerator().generate(root);
+        auto pass_manager = IR::PassManager::create(args.pipeline);
+        pass_manager.verify_each = args.verify_each;
+        pass_manager.run(*module);
+        pass_manager.print_report(std::cout);
+        IR::Verifier verifier;
+        if (!verifier.verify(*module))
+          throw std::runtime_error("IR verification failed:\n" +
+                                   verifier.message());
+        if (args.output_file.empty()) {
+          module->print(std::cout);
+        } else {
+          std::ofstream out(args.output_file);
+          if (!out)
+            throw std::runtime_error("Cannot open file: " + args.output_file);
+          module->print(out);
+        }
+      }
     }
 
     return 0;
@@ -0,0 +1,48 @@
+#include "adce.hpp"
+
+#include <vector>
+
+namespace IR {
+
+std::string ADCE::stats() const {
+  return "removed " + std::to_string(removed) + " instructions";
+}
+
+PreservedAnalyses ADCE::run(Function &func, AnalysisManager &) {
+  std::vector<bool> live(func.insts.size(), false);
+  std::vector<ValueId> worklist;
+  for (auto &block : func.blocks)
+    for (auto id : block.insts)
+      if (func.has_side_effects(id)) {
+        live[id] = true;
+        worklist.push_back(id);
+      }
+  while (!worklist.empty()) {
+    auto &inst = func[worklist.back()];
+    worklist.pop_back();
+    for (uint32_t i = 0; i < inst.num_ops; i++) {
+      ValueId op = inst.ops[i];
+      if (live[op] || is_floating(func[op].op)) continue;
+      live[op] = true;
+      worklist.push_back(op);
+    }
+  }
+
+  std::vector<bool> dead(func.insts.size(), false);
+  int count = 0;
+  for (auto &block : func.blocks)
+    for (auto id : block.insts)
+      if (!live[id]) {
+        dead[id] = true;
+        count++;
+      }
+  if (!count) return PreservedAnalyses::all();
+  func.remove_insts(dead);
+  removed += count;
+  return PreservedAnalyses::none()
+      .preserve(AnalysisKind::CFG)
+      .preserve(AnalysisKind::Dominators)
+      .preserve(AnalysisKind::Loops);
+}
+
+}  // namespace IR
@@ -0,0 +1,25 @@
+#ifndef OPT_ADCE_HPP
+#define OPT_ADCE_HPP
+
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Aggressive dead code elimination. Instructions are assumed dead
+/// until proven live: stores, calls (`write` and `read` included) and
+/// terminators are live, and so is every operand of a live instruction.
+/// Unlike deleting unused values one by one, this also removes cycles of
+/// phis and arithmetic that only feed each other.
+class ADCE : public FunctionPass {
+ public:
+  const char *name() const override { return "adce"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Function &func, AnalysisManager &am) override;
+
+ private:
+  int removed = 0;
+};
+
+}  // namespace IR
+
+#endif  // OPT_ADCE_HPP
@@ -0,0 +1,130 @@
+#include "div_const.hpp"
+
+#include <climits>
+#include <vector>
+
+namespace IR {
+
+std::string DivByConst::stats() const {
+  return "rewrote " + std::to_string(divisions) + " divisions and " +
+         std::to_string(remainders) + " remainders (" +
+         std::to_string(shifts) + " by powers of two)";
+}
+
+PreservedAnalyses DivByConst::run(Function &func, AnalysisManager &) {
+  std::vector<ValueId> worklist;
+  for (auto &block : func.blocks)
+    for (auto id : block.insts) {
+      auto &inst = func[id];
+      if ((inst.op == Opcode::Div || inst.op == Opcode::Mod) &&
+          func.is_const(inst.ops[1]) && func[inst.ops[1]].imm != 0)
+        worklist.push_back(id);
+    }
+  if (worklist.empty()) return PreservedAnalyses::all();
+
+  std::vector<bool> dead(func.insts.size(), false);
+  for (auto id : worklist) {
+    ValueId x = func[id].ops[0];
+    int32_t d = func[func[id].ops[1]].imm;
+    ValueId result;
+    if (func[id].op == Opcode::Div) {
+      result = quotient(func, id, x, d);
+      divisions++;
+    } else if (d == 1 || d == -1) {
+      result = func.const_int(0);
+      remainders++;
+    } else {
+      // 余数的符号只跟被除数有关，x % d == x % -d
+      if (d < 0 && d != INT_MIN) d = -d;
+      ValueId q = quotient(func, id, x, d);
+      uint32_t ud = d;
+      ValueId product;
+      if ((ud & (ud - 1)) == 0)
+        product = emit(func, id, Opcode::Shl, q,
+                       func.const_int(__builtin_ctz(ud)));
+      else
+        product = emit(func, id, Opcode::Mul, q, func.const_int(d));
+      result = emit(func, id, Opcode::Sub, x, product);
+      remainders++;
+    }
+    func.replace_all_uses(id, result);
+    dead.resize(func.insts.size(), false);
+    dead[id] = true;
+  }
+  func.remove_insts(dead);
+  return PreservedAnalyses::none()
+      .preserve(AnalysisKind::CFG)
+      .preserve(AnalysisKind::Dominators)
+      .preserve(AnalysisKind::Loops);
+}
+
+DivByConst::Magic DivByConst::magic(int32_t d) {
+  // Hacker's Delight 10-1：找最小的 p 使 2^p / |d| 的上取整误差足够小
+  const uint32_t two31 = 0x80000000u;
+  uint32_t ad = d < 0 ? -(uint32_t)d : d;
+  uint32_t t = two31 + ((uint32_t)d >> 31);
+  uint32_t anc = t - 1 - t % ad;
+  int p = 31;
+  uint32_t q1 = two31 / anc, r1 = two31 - q1 * anc;
+  uint32_t q2 = two31 / ad, r2 = two31 - q2 * ad;
+  uint32_t delta;
+  do {
+    p++;
+    q1 *= 2;
+    r1 *= 2;
+    if (r1 >= anc) {
+      q1++;
+      r1 -= anc;
+    }
+    q2 *= 2;
+    r2 *= 2;
+    if (r2 >= ad) {
+      q2++;
+      r2 -= ad;
+    }
+    delta = ad - r2;
+  } while (q1 < delta || (q1 == delta && r1 == 0));
+  uint32_t m = q2 + 1;
+  return Magic{(int32_t)(d < 0 ? -m : m), p - 32};
+}
+
+ValueId DivByConst::quotient(Function &func, ValueId pos, ValueId x,
+                             int32_t d) {
+  if (d == 1) return x;
+  if (d == -1) return emit(func, pos, Opcode::Sub, func.const_int(0), x);
+  // 只有 INT_MIN / INT_MIN 的商不为零
+  if (d == INT_MIN) {
+    shifts++;
+    return emit(func, pos, Opcode::Eq, x, func.const_int(INT_MIN));
+  }
+  uint32_t ad = d < 0 ? -(uint32_t)d : d;
+  if ((ad & (ad - 1)) == 0) {
+    // 负数先加上 2^k - 1，使算术右移向零取整
+    shifts++;
+    int k = __builtin_ctz(ad);
+    ValueId sign = emit(func, pos, Opcode::AShr, x, func.const_int(k - 1));
+    ValueId bias = emit(func, pos, Opcode::LShr, sign, func.const_int(32 - k));
+    ValueId sum = emit(func, pos, Opcode::Add, x, bias);
+    ValueId q = emit(func, pos, Opcode::AShr, sum, func.const_int(k));
+    if (d > 0) return q;
+    return emit(func, pos, Opcode::Sub, func.const_int(0), q);
+  }
+  auto [m, s] = magic(d);
+  ValueId q = emit(func, pos, Opcode::MulHi, x, func.const_int(m));
+  // 乘数的符号与除数不同时，乘数实际被截成了 m - 2^32 或 m + 2^32
+  if (d > 0 && m < 0) q = emit(func, pos, Opcode::Add, q, x);
+  if (d < 0 && m > 0) q = emit(func, pos, Opcode::Sub, q, x);
+  if (s > 0) q = emit(func, pos, Opcode::AShr, q, func.const_int(s));
+  // 结果为负时向下取整多减了 1，加回符号位
+  ValueId sign = emit(func, pos, Opcode::LShr, q, func.const_int(31));
+  return emit(func, pos, Opcode::Add, q, sign);
+}
+
+ValueId DivByConst::emit(Function &func, ValueId pos, Opcode op, ValueId lhs,
+                         ValueId rhs) {
+  ValueId inst = func.create(op, Type::I32, {lhs, rhs});
+  func.insert_before(pos, inst);
+  return inst;
+}
+
+}  // namespace IR
@@ -0,0 +1,41 @@
+#ifndef OPT_DIV_CONST_HPP
+#define OPT_DIV_CONST_HPP
+
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Division and remainder by a constant without a divide. A
+/// quotient is the high half of the product with a "magic" reciprocal,
+/// corrected and shifted so that it truncates towards zero exactly as C
+/// does; powers of two need only the shifts that round a negative dividend
+/// up. A remainder is the dividend minus the quotient times the divisor.
+/// Divisions by zero are left to fault at run time.
+class DivByConst : public FunctionPass {
+ public:
+  const char *name() const override { return "div-const"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Function &func, AnalysisManager &am) override;
+
+  /// @brief The multiplier and shift of the signed division by `d`, where
+  /// |d| >= 2 is not a power of two
+  struct Magic {
+    int32_t multiplier;
+    int shift;
+  };
+  static Magic magic(int32_t d);
+
+ private:
+  int divisions = 0;
+  int remainders = 0;
+  int shifts = 0;
+
+  /// @brief Emit `x / d` in front of `pos`
+  ValueId quotient(Function &func, ValueId pos, ValueId x, int32_t d);
+  static ValueId emit(Function &func, ValueId pos, Opcode op, ValueId lhs,
+                      ValueId rhs);
+};
+
+}  // namespace IR
+
+#endif  // OPT_DIV_CONST_HPP
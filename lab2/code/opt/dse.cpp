@@ -0,0 +1,153 @@
+#include "dse.hpp"
+
+#include <algorithm>
+
+namespace IR {
+
+std::string DeadStoreElim::stats() const {
+  return "removed " + std::to_string(removed) + " stores";
+}
+
+PreservedAnalyses DeadStoreElim::run(Module &module, AnalysisManager &am) {
+  ModuleAliasInfo info(module);
+  // 只删除了 store，控制流不变
+  auto kept = PreservedAnalyses::none()
+                  .preserve(AnalysisKind::CFG)
+                  .preserve(AnalysisKind::Dominators)
+                  .preserve(AnalysisKind::Loops);
+  bool changed = false;
+  for (size_t index = 0; index < module.functions.size(); index++) {
+    auto &func = *module.functions[index];
+    if (func.is_external) continue;
+    AliasAnalysis aa(func, info, index);
+    if (!runOnFunction(func, am.cfg(func), aa)) continue;
+    am.invalidate(func, kept);
+    changed = true;
+  }
+  return changed ? kept : PreservedAnalyses::all();
+}
+
+bool DeadStoreElim::runOnFunction(Function &func, const CFG &cfg,
+                                  const AliasAnalysis &aa) {
+  // 从不被 load 也不传给调用的栈槽，写进去的值没有人会看到
+  std::vector<bool> read(func.insts.size(), false);
+  bool read_unknown = false;
+  auto reads = [&](ValueId ptr) {
+    ValueId obj = aa.object(ptr);
+    if (obj == kNoValue)
+      read_unknown = true;
+    else
+      read[obj] = true;
+  };
+  for (auto &block : func.blocks)
+    for (auto id : block.insts) {
+      auto &inst = func[id];
+      if (inst.op == Opcode::Load) reads(inst.ops[0]);
+      if (inst.op != Opcode::Call || (inst.flags & kCallNoMemory)) continue;
+      for (uint32_t i = 0; i < inst.num_ops; i++)
+        if (func[inst.ops[i]].type == Type::Ptr) reads(inst.ops[i]);
+    }
+
+  std::vector<State> in(func.num_blocks());
+  std::vector<bool> dead(func.insts.size(), false);
+  bool changed = false;
+  for (auto it = cfg.rpo.rbegin(); it != cfg.rpo.rend(); ++it) {
+    BlockId bb = *it;
+    State state = exitState(cfg, in, bb);
+    auto &overwritten = state.overwritten;
+    auto &live = state.live;
+    // 调用者看不到本函数的栈槽，返回前没有再读的写入都是死的
+    auto dies = [&](ValueId obj) {
+      if (obj == kNoValue || func[obj].op != Opcode::Alloca) return false;
+      if (!read_unknown && !read[obj]) return true;
+      return state.frame_dead &&
+             std::find(live.begin(), live.end(), obj) == live.end();
+    };
+    auto frame_read = [&](ValueId ptr) {
+      ValueId obj = aa.object(ptr);
+      if (obj == kNoValue)
+        state.frame_dead = false;
+      else if (func[obj].op == Opcode::Alloca &&
+               std::find(live.begin(), live.end(), obj) == live.end())
+        live.push_back(obj);
+    };
+
+    auto &insts = func.blocks[bb].insts;
+    for (auto i = insts.rbegin(); i != insts.rend(); ++i) {
+      ValueId id = *i;
+      auto &inst = func[id];
+      if (inst.op == Opcode::Store) {
+        ValueId ptr = inst.ops[1];
+        bool again = std::any_of(
+            overwritten.begin(), overwritten.end(),
+            [&](ValueId other) { return aa.must_alias(other, ptr); });
+        if (again || dies(aa.object(ptr))) {
+          dead[id] = true;
+          removed++;
+          changed = true;
+          continue;
+        }
+        if (overwritten.size() == kMaxPending)
+          overwritten.erase(overwritten.begin());
+        overwritten.push_back(ptr);
+      } else if (inst.op == Opcode::Load) {
+        ValueId ptr = inst.ops[0];
+        overwritten.erase(
+            std::remove_if(overwritten.begin(), overwritten.end(),
+                           [&](ValueId other) {
+                             return aa.may_alias(other, ptr);
+                           }),
+            overwritten.end());
+        frame_read(ptr);
+      } else if (inst.op == Opcode::Call && !(inst.flags & kCallNoMemory)) {
+        overwritten.erase(
+            std::remove_if(overwritten.begin(), overwritten.end(),
+                           [&](ValueId other) {
+                             return aa.may_read(id, other);
+                           }),
+            overwritten.end());
+        for (uint32_t k = 0; k < inst.num_ops; k++)
+          if (func[inst.ops[k]].type == Type::Ptr) frame_read(inst.ops[k]);
+      }
+    }
+    in[bb] = std::move(state);
+  }
+  if (changed) func.remove_insts(dead);
+  return changed;
+}
+
+DeadStoreElim::State DeadStoreElim::exitState(const CFG &cfg,
+                                              const std::vector<State> &in,
+                                              BlockId bb) {
+  auto &succs = cfg.succs[bb];
+  State state;
+  if (succs.empty()) {
+    // 函数返回
+    state.frame_dead = true;
+    return state;
+  }
+  // 后继还没访问过说明是回边，保守地认为之后什么都会读
+  for (auto succ : succs)
+    if (cfg.rpo_index[succ] <= cfg.rpo_index[bb]) return state;
+  state = in[succs[0]];
+  for (size_t i = 1; i < succs.size(); i++) {
+    auto &other = in[succs[i]];
+    auto &overwritten = state.overwritten;
+    overwritten.erase(
+        std::remove_if(overwritten.begin(), overwritten.end(),
+                       [&](ValueId v) {
+                         return std::find(other.overwritten.begin(),
+                                          other.overwritten.end(),
+                                          v) == other.overwritten.end();
+                       }),
+        overwritten.end());
+    state.frame_dead &= other.frame_dead;
+    for (auto obj : other.live)
+      if (std::find(state.live.begin(), state.live.end(), obj) ==
+          state.live.end())
+        state.live.push_back(obj);
+  }
+  return state;
+}
+
+}  // namespace IR
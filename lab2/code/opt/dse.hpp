@@ -0,0 +1,51 @@
+#ifndef OPT_DSE_HPP
+#define OPT_DSE_HPP
+
+#include <vector>
+
+#include "analysis/alias.hpp"
+#include "analysis/cfg.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Dead store elimination. A store is dead when the element it
+/// writes is overwritten on every path before anything may read it, or
+/// when it goes to a stack slot of the function that is not read again
+/// before returning. Blocks are walked backwards in postorder keeping the
+/// addresses that are certain to be overwritten and whether the frame is
+/// still to be read; a block whose successor has not been seen yet, i.e.
+/// the end of a loop body, assumes everything is read. Stack slots that
+/// are never loaded from nor passed to a call lose all of their stores.
+class DeadStoreElim : public ModulePass {
+ public:
+  /// @brief The most overwritten addresses kept at a time
+  static constexpr size_t kMaxPending = 64;
+
+  const char *name() const override { return "dse"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Module &module, AnalysisManager &am) override;
+
+ private:
+  /// @brief What the code after a point does to memory
+  struct State {
+    /// @brief Addresses stored to before any read that may alias them
+    std::vector<ValueId> overwritten;
+    /// @brief Whether the function returns before reading its frame,
+    /// except for the stack slots in `live`
+    bool frame_dead = false;
+    std::vector<ValueId> live;
+  };
+
+  int removed = 0;
+
+  /// @return whether any store was removed
+  bool runOnFunction(Function &func, const CFG &cfg, const AliasAnalysis &aa);
+  /// @brief The state at the end of `bb`, met over its successors
+  static State exitState(const CFG &cfg, const std::vector<State> &in,
+                         BlockId bb);
+};
+
+}  // namespace IR
+
+#endif  // OPT_DSE_HPP
@@ -0,0 +1,144 @@
+#include "gvn.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace IR {
+
+std::string GVN::stats() const {
+  return "eliminated " + std::to_string(eliminated) + " instructions";
+}
+
+size_t GVN::KeyHash::operator()(const Key &key) const {
+  size_t h = static_cast<size_t>(key.op) * 31 + key.block;
+  for (auto v : key.ops) h = h * 1000003 + v;
+  return h;
+}
+
+PreservedAnalyses GVN::run(Function &func, AnalysisManager &am) {
+  this->func = &func;
+  replacement.assign(func.insts.size(), kNoValue);
+  auto &dom = am.dominators(func);
+  if (dom.preorder().empty()) return PreservedAnalyses::all();
+
+  // 作用域哈希表：离开一个块的支配子树时撤销它加入的表项
+  std::unordered_map<Key, ValueId, KeyHash> table;
+  std::vector<std::vector<Key>> added(func.num_blocks());
+  std::vector<bool> dead(func.insts.size(), false);
+  int before = eliminated;
+  std::vector<std::pair<BlockId, bool>> worklist{{dom.preorder()[0], false}};
+  while (!worklist.empty()) {
+    auto [bb, leaving] = worklist.back();
+    worklist.pop_back();
+    if (leaving) {
+      for (auto &key : added[bb]) table.erase(key);
+      added[bb].clear();
+      continue;
+    }
+    worklist.emplace_back(bb, true);
+
+    for (auto id : func.blocks[bb].insts) {
+      auto &inst = func[id];
+      for (uint32_t i = 0; i < inst.num_ops; i++)
+        inst.ops[i] = resolve(inst.ops[i]);
+      ValueId same = simplify(id);
+      Key key;
+      if (same == kNoValue && makeKey(id, key)) {
+        auto [it, inserted] = table.emplace(key, id);
+        if (inserted)
+          added[bb].push_back(std::move(key));
+        else
+          same = it->second;
+      }
+      if (same == kNoValue) continue;
+      if (replacement.size() < func.insts.size())
+        replacement.resize(func.insts.size(), kNoValue);
+      replacement[id] = same;
+      dead[id] = true;
+      eliminated++;
+    }
+    for (auto child : dom.children(bb)) worklist.emplace_back(child, false);
+  }
+  if (eliminated == before) return PreservedAnalyses::all();
+
+  // 支配树中先访问到的块（如循环头）可能还引用着被替换的值
+  for (auto &block : func.blocks)
+    for (auto id : block.insts) {
+      auto &inst = func[id];
+      for (uint32_t i = 0; i < inst.num_ops; i++)
+        inst.ops[i] = resolve(inst.ops[i]);
+    }
+  func.remove_insts(dead);
+  return PreservedAnalyses::none()
+      .preserve(AnalysisKind::CFG)
+      .preserve(AnalysisKind::Dominators)
+      .preserve(AnalysisKind::Loops);
+}
+
+ValueId GVN::simplify(ValueId id) {
+  auto &inst = (*func)[id];
+  if (is_binary(inst.op) && func->is_const(inst.ops[0]) &&
+      func->is_const(inst.ops[1])) {
+    auto value = eval_binary(inst.op, (*func)[inst.ops[0]].imm,
+                             (*func)[inst.ops[1]].imm);
+    // 除零留到运行时
+    if (value) return func->const_int(*value);
+  }
+  if (inst.op == Opcode::Select) {
+    ValueId cond = inst.ops[0];
+    if (func->is_const(cond)) return inst.ops[(*func)[cond].imm ? 1 : 2];
+    if (inst.ops[1] == inst.ops[2]) return inst.ops[1];
+  }
+  if (inst.op == Opcode::Phi && inst.num_ops > 0) {
+    // 除了自身以外只有一个不同的来值
+    ValueId unique = kNoValue;
+    for (uint32_t i = 0; i < inst.num_ops; i++) {
+      ValueId v = inst.ops[i];
+      if (v == id || v == unique) continue;
+      if (unique != kNoValue) return kNoValue;
+      unique = v;
+    }
+    return unique;
+  }
+  return kNoValue;
+}
+
+bool GVN::makeKey(ValueId id, Key &key) const {
+  auto &inst = (*func)[id];
+  key.op = inst.op;
+  key.block = 0;
+  key.ops.assign(inst.ops, inst.ops + inst.num_ops);
+  if (is_binary(inst.op)) {
+    if (inst.op == Opcode::Gt || inst.op == Opcode::Ge) {
+      key.op = inst.op == Opcode::Gt ? Opcode::Lt : Opcode::Le;
+      std::swap(key.ops[0], key.ops[1]);
+    } else if (is_commutative(inst.op) && key.ops[1] < key.ops[0]) {
+      std::swap(key.ops[0], key.ops[1]);
+    }
+    return true;
+  }
+  if (inst.op == Opcode::Gep || inst.op == Opcode::Select) return true;
+  if (inst.op == Opcode::Phi) {
+    // 同一个块中来值相同的 phi，按前驱排好序再比较
+    std::vector<std::pair<BlockId, ValueId>> incoming;
+    for (uint32_t i = 0; i < inst.num_ops; i++)
+      incoming.emplace_back(inst.targets[i], inst.ops[i]);
+    std::sort(incoming.begin(), incoming.end());
+    key.block = inst.block;
+    key.ops.clear();
+    for (auto &[from, v] : incoming) {
+      key.ops.push_back(from);
+      key.ops.push_back(v);
+    }
+    return true;
+  }
+  return false;
+}
+
+ValueId GVN::resolve(ValueId value) const {
+  while (value < replacement.size() && replacement[value] != kNoValue)
+    value = replacement[value];
+  return value;
+}
+
+}  // namespace IR
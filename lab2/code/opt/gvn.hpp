@@ -0,0 +1,51 @@
+#ifndef OPT_GVN_HPP
+#define OPT_GVN_HPP
+
+#include <unordered_map>
+#include <vector>
+
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Dominator-based global value numbering. Pure instructions are
+/// hashed by opcode and operands in a scope per dominator subtree; an
+/// instruction equal to one in a dominating block is replaced by it.
+/// Commutative operands are ordered and `gt`/`ge` are turned around into
+/// `lt`/`le`, constant operations are folded and phis whose incoming values
+/// are all the same are removed.
+class GVN : public FunctionPass {
+ public:
+  const char *name() const override { return "gvn"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Function &func, AnalysisManager &am) override;
+
+ private:
+  struct Key {
+    Opcode op;
+    /// @brief The block of a phi, 0 otherwise
+    BlockId block;
+    std::vector<ValueId> ops;
+    bool operator==(const Key &other) const {
+      return op == other.op && block == other.block && ops == other.ops;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key &key) const;
+  };
+
+  Function *func = nullptr;
+  /// @brief The value that replaces each eliminated instruction
+  std::vector<ValueId> replacement;
+  int eliminated = 0;
+
+  /// @brief The value `id` simplifies to, kNoValue if none
+  ValueId simplify(ValueId id);
+  /// @brief The hash key of a pure instruction, false for others
+  bool makeKey(ValueId id, Key &key) const;
+  ValueId resolve(ValueId value) const;
+};
+
+}  // namespace IR
+
+#endif  // OPT_GVN_HPP
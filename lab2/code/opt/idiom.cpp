@@ -0,0 +1,202 @@
+#include "idiom.hpp"
+
+#include <algorithm>
+#include <memory>
+
+namespace IR {
+
+std::string IdiomRecognize::stats() const {
+  return "replaced " + std::to_string(fills) + " fill, " +
+         std::to_string(copies) + " copy and " + std::to_string(sums) +
+         " sum loops";
+}
+
+PreservedAnalyses IdiomRecognize::run(Module &module, AnalysisManager &am) {
+  // 知道形参数组来自哪里，才能证明复制的两个数组不同
+  ModuleAliasInfo info(module);
+  bool changed = false;
+  for (size_t f = 0; f < module.functions.size(); f++) {
+    auto &func = *module.functions[f];
+    if (func.is_external) continue;
+    auto &loops = am.loops(func);
+    AliasAnalysis aa(func, info, f);
+    std::vector<std::pair<const Loop *, std::unique_ptr<InductionInfo>>> candidates;
+    for (auto loop : loops.loops()) {
+      if (!loop->children.empty() || loop->blocks.size() != 2) continue;
+      auto ind = std::make_unique<InductionInfo>(func, loops, *loop);
+      if (ind->exit_test()) candidates.emplace_back(loop, std::move(ind));
+    }
+    bool replaced = false;
+    for (auto &[loop, ind] : candidates)
+      replaced |= replaceLoop(module, func, loops, *loop, *ind, aa);
+    if (!replaced) continue;
+    // 循环本身变得不可达
+    func.remove_unreachable_blocks();
+    am.invalidate(func, PreservedAnalyses::none());
+    changed = true;
+  }
+  return changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+}
+
+int IdiomRecognize::runtime(Module &module, const std::string &name, Type ret,
+                            const std::vector<Type> &params) {
+  int index = module.find_function(name);
+  if (index >= 0) return index;
+  return module.add_function(Function::create(name, ret, params, true));
+}
+
+ValueId IdiomRecognize::firstAddress(Function &func, BlockId pre,
+                                     const InductionInfo &ind, ValueId gep) {
+  auto &form = *ind.affine(func[gep].ops[1]);
+  ValueId index = ind.ivs()[form.iv].init;
+  auto add = [&](ValueId lhs, ValueId rhs) {
+    auto inst = func.create(Opcode::Add, Type::I32, {lhs, rhs});
+    func.insert_before_terminator(pre, inst);
+    return inst;
+  };
+  if (form.value != kNoValue) index = add(index, form.value);
+  if (form.constant != 0) index = add(index, func.const_int(form.constant));
+  auto addr = func.create(Opcode::Gep, Type::Ptr, {func[gep].ops[0], index});
+  func.insert_before_terminator(pre, addr);
+  return addr;
+}
+
+bool IdiomRecognize::replaceLoop(Module &module, Function &func,
+                                 const LoopInfo &loops, const Loop &loop,
+                                 const InductionInfo &ind,
+                                 const AliasAnalysis &aa) {
+  auto &test = *ind.exit_test();
+  auto &iv = ind.ivs()[test.iv];
+  if (iv.step != 1 || (test.op != Opcode::Lt && test.op != Opcode::Le))
+    return false;
+  BlockId header = loop.header, body = loop.latches[0], pre = loop.preheader;
+  if (body == header) return false;
+
+  // 循环头只有 phi、退出比较和分支，多出的 phi 只能是累加值
+  ValueId acc = kNoValue;
+  for (auto id : func.blocks[header].insts) {
+    if (id == iv.phi || id == test.cmp || id == func.terminator(header))
+      continue;
+    if (func[id].op != Opcode::Phi || acc != kNoValue) return false;
+    acc = id;
+  }
+
+  // 循环体里只能有一次读、一次写、地址计算和循环控制
+  ValueId load = kNoValue, store = kNoValue, acc_next = kNoValue;
+  for (auto id : func.blocks[body].insts) {
+    auto &inst = func[id];
+    if (id == iv.next || inst.op == Opcode::Br) continue;
+    if (inst.op == Opcode::Gep && ind.invariant(inst.ops[0])) {
+      auto form = ind.affine(inst.ops[1]);
+      if (form && form->scale == 1 && ind.ivs()[form->iv].phi == iv.phi)
+        continue;
+      return false;
+    }
+    if (ind.affine(id)) continue;
+    if (inst.op == Opcode::Load && load == kNoValue) {
+      load = id;
+    } else if (inst.op == Opcode::Store && store == kNoValue) {
+      store = id;
+    } else if (acc != kNoValue && acc_next == kNoValue && inst.op == Opcode::Add &&
+               func.incoming(acc, body) == id) {
+      acc_next = id;
+    } else {
+      return false;
+    }
+  }
+  auto is_gep = [&](ValueId v) {
+    return func[v].op == Opcode::Gep && func[v].block == body;
+  };
+  if (load != kNoValue && !is_gep(func[load].ops[0])) return false;
+  if (store != kNoValue && !is_gep(func[store].ops[1])) return false;
+
+  // 除了累加结果，循环中的值不能在循环外使用
+  std::vector<std::vector<ValueId>> users(func.insts.size());
+  for (auto &block : func.blocks)
+    for (auto id : block.insts)
+      for (uint32_t i = 0; i < func[id].num_ops; i++)
+        users[func[id].ops[i]].push_back(id);
+  for (auto bb : loop.blocks)
+    for (auto id : func.blocks[bb].insts) {
+      if (id == acc) continue;
+      for (auto u : users[id])
+        if (!loops.contains(&loop, func[u].block)) return false;
+    }
+
+  enum { Fill, Copy, Sum } kind;
+  if (store != kNoValue && load == kNoValue && acc == kNoValue &&
+      ind.invariant(func[store].ops[0])) {
+    kind = Fill;
+  } else if (store != kNoValue && load != kNoValue && acc == kNoValue &&
+             func[store].ops[0] == load) {
+    // memcpy 不允许重叠，两个数组必须确定是不同的对象
+    ValueId dst = aa.object(func[store].ops[1]), src = aa.object(func[load].ops[0]);
+    if (dst == kNoValue || src == kNoValue || dst == src ||
+        aa.may_alias(func[store].ops[1], func[load].ops[0]))
+      return false;
+    kind = Copy;
+  } else if (store == kNoValue && load != kNoValue && acc_next != kNoValue) {
+    auto &add = func[acc_next];
+    bool sum = (add.ops[0] == acc && add.ops[1] == load) ||
+               (add.ops[1] == acc && add.ops[0] == load);
+    if (!sum || users[load].size() != 1 || users[acc].size() < 1) return false;
+    for (auto u : users[acc])
+      if (u != acc_next && loops.contains(&loop, func[u].block)) return false;
+    kind = Sum;
+  } else {
+    return false;
+  }
+
+  // 次数 n - i (或 n - i + 1) 在前置块中算出
+  ValueId count = func.create(Opcode::Sub, Type::I32, {test.bound, iv.init});
+  func.insert_before_terminator(pre, count);
+  if (test.op == Opcode::Le) {
+    auto inc = func.create(Opcode::Add, Type::I32, {count, func.const_int(1)});
+    func.insert_before_terminator(pre, inc);
+    count = inc;
+  }
+  ValueId call = kNoValue;
+  switch (kind) {
+    case Fill: {
+      int callee = runtime(module, "sysy.memset", Type::Void,
+                           {Type::Ptr, Type::I32, Type::I32});
+      ValueId dst = firstAddress(func, pre, ind, func[store].ops[1]);
+      call = func.create(Opcode::Call, Type::Void,
+                         {dst, func[store].ops[0], count}, {}, callee);
+      fills++;
+      break;
+    }
+    case Copy: {
+      int callee = runtime(module, "sysy.memcpy", Type::Void,
+                           {Type::Ptr, Type::Ptr, Type::I32});
+      ValueId dst = firstAddress(func, pre, ind, func[store].ops[1]);
+      ValueId src = firstAddress(func, pre, ind, func[load].ops[0]);
+      call = func.create(Opcode::Call, Type::Void, {dst, src, count}, {}, callee);
+      copies++;
+      break;
+    }
+    case Sum: {
+      int callee = runtime(module, "sysy.sum", Type::I32, {Type::Ptr, Type::I32});
+      ValueId src = firstAddress(func, pre, ind, func[load].ops[0]);
+      call = func.create(Opcode::Call, Type::I32, {src, count}, {}, callee);
+      sums++;
+      break;
+    }
+  }
+  func.insert_before_terminator(pre, call);
+
+  // 前置块直接跳到出口，累加值的使用改为初值加上总和
+  BlockId exit = func[func.terminator(header)].targets[1];
+  ValueId result = kNoValue;
+  if (kind == Sum) {
+    result = func.create(Opcode::Add, Type::I32,
+                         {func.incoming(acc, pre), call});
+    func.insert_before_terminator(pre, result);
+    func.replace_all_uses(acc, result);
+  }
+  func.replace_target(func.terminator(pre), header, exit);
+  func.replace_incoming_block(exit, header, pre);
+  return true;
+}
+
+}  // namespace IR
@@ -0,0 +1,45 @@
+#ifndef OPT_IDIOM_HPP
+#define OPT_IDIOM_HPP
+
+#include "analysis/alias.hpp"
+#include "analysis/induction.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Replaces whole loops by calls to runtime routines:
+///   while (i < n) { a[i] = v; i = i + 1; }        sysy.memset(&a[i], v, n - i)
+///   while (i < n) { a[i] = b[i]; i = i + 1; }     sysy.memcpy(&a[i], &b[i], n - i)
+///   while (i < n) { s = s + a[i]; i = i + 1; }    s + sysy.sum(&a[i], n - i)
+/// The routines are declared in the module on first use and treat a count
+/// below one as zero. The SysY runtime does not define them, so the pass
+/// is not part of any optimization level; enable it with e.g.
+/// `--passes=O2,idiom` when linking a runtime that does. A loop qualifies when it is an innermost counted
+/// loop stepping by one, its body is exactly the pattern, nothing but the
+/// sum is used after it, and for copies the arrays are provably distinct.
+class IdiomRecognize : public ModulePass {
+ public:
+  const char *name() const override { return "idiom"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Module &module, AnalysisManager &am) override;
+
+ private:
+  int fills = 0;
+  int copies = 0;
+  int sums = 0;
+
+  /// @brief The index of runtime routine `name`, declared if needed
+  static int runtime(Module &module, const std::string &name, Type ret,
+                     const std::vector<Type> &params);
+  bool replaceLoop(Module &module, Function &func, const LoopInfo &loops,
+                   const Loop &loop, const InductionInfo &ind,
+                   const AliasAnalysis &aa);
+  /// @brief Emit `base + index` at the end of the preheader for the first
+  /// iteration, where `index` is the induction variable plus an offset
+  static ValueId firstAddress(Function &func, BlockId pre,
+                              const InductionInfo &ind, ValueId gep);
+};
+
+}  // namespace IR
+
+#endif  // OPT_IDIOM_HPP
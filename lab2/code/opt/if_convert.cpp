@@ -0,0 +1,148 @@
+#include "if_convert.hpp"
+
+#include <vector>
+
+namespace IR {
+
+std::string IfConversion::stats() const {
+  return "converted " + std::to_string(converted) + " branches into " +
+         std::to_string(selects) + " selects";
+}
+
+PreservedAnalyses IfConversion::run(Function &func, AnalysisManager &) {
+  int before = converted;
+  // 内层的分支转换后外层才可能成为菱形，所以一直做到没有变化
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    CFG cfg(func);
+    std::vector<bool> touched(func.num_blocks(), false);
+    for (auto bb : cfg.rpo) {
+      Diamond d;
+      if (func.blocks[bb].removed || touched[bb]) continue;
+      if (!match(func, cfg, bb, d) || touched[d.join]) continue;
+      if ((d.arms[0] != kNoBlock && touched[d.arms[0]]) ||
+          (d.arms[1] != kNoBlock && touched[d.arms[1]]))
+        continue;
+      if (cost(func, d) > kMaxCost) continue;
+      convert(func, d);
+      touched[d.head] = touched[d.join] = true;
+      changed = true;
+    }
+  }
+  if (converted == before) return PreservedAnalyses::all();
+  return PreservedAnalyses::none();
+}
+
+bool IfConversion::match(const Function &func, const CFG &cfg, BlockId bb,
+                         Diamond &d) {
+  ValueId term = func.terminator(bb);
+  if (term == kNoValue || func[term].op != Opcode::CondBr) return false;
+  BlockId on_true = func[term].targets[0], on_false = func[term].targets[1];
+  if (on_true == on_false) return false;
+  // 分支的一臂：只从 bb 进入，只计算值，然后跳走
+  auto next = [&](BlockId arm) {
+    if (arm == bb || cfg.preds[arm].size() != 1) return kNoBlock;
+    auto &insts = func.blocks[arm].insts;
+    ValueId br = func.terminator(arm);
+    if (br == kNoValue || func[br].op != Opcode::Br) return kNoBlock;
+    for (size_t i = 0; i + 1 < insts.size(); i++)
+      if (!speculatable(func, bb, insts[i])) return kNoBlock;
+    return func[br].targets[0];
+  };
+  BlockId true_next = next(on_true), false_next = next(on_false);
+  d.head = bb;
+  if (true_next != kNoBlock && true_next == false_next) {
+    d.join = true_next;
+    d.arms[0] = on_true;
+    d.arms[1] = on_false;
+  } else if (true_next == on_false) {
+    d.join = on_false;
+    d.arms[0] = on_true;
+    d.arms[1] = kNoBlock;
+  } else if (false_next == on_true) {
+    d.join = on_true;
+    d.arms[0] = kNoBlock;
+    d.arms[1] = on_false;
+  } else {
+    return false;
+  }
+  if (d.join == bb) return false;
+  // select 只能选择 i32
+  for (auto id : func.blocks[d.join].insts) {
+    if (func[id].op != Opcode::Phi) break;
+    if (func[id].type != Type::I32 &&
+        func.incoming(id, d.from(0)) != func.incoming(id, d.from(1)))
+      return false;
+  }
+  return true;
+}
+
+bool IfConversion::speculatable(const Function &func, BlockId head,
+                                ValueId inst) {
+  auto &i = func[inst];
+  if (i.op == Opcode::Div || i.op == Opcode::Mod) {
+    ValueId divisor = i.ops[1];
+    return func.is_const(divisor) && func[divisor].imm != 0 &&
+           func[divisor].imm != -1;
+  }
+  if (i.op == Opcode::Load) {
+    // 分支前已经访问过的地址不会出错，臂中又没有写内存的指令，
+    // 提前到分支前读到的值不变
+    for (auto id : func.blocks[head].insts) {
+      auto &access = func[id];
+      if ((access.op == Opcode::Load && access.ops[0] == i.ops[0]) ||
+          (access.op == Opcode::Store && access.ops[1] == i.ops[0]))
+        return true;
+    }
+    return false;
+  }
+  return is_binary(i.op) || i.op == Opcode::Gep || i.op == Opcode::Select;
+}
+
+int IfConversion::cost(const Function &func, const Diamond &d) {
+  int n = 0;
+  for (auto arm : d.arms)
+    if (arm != kNoBlock) n += func.blocks[arm].insts.size() - 1;
+  for (auto id : func.blocks[d.join].insts) {
+    if (func[id].op != Opcode::Phi) break;
+    if (func.incoming(id, d.from(0)) != func.incoming(id, d.from(1))) n++;
+  }
+  return n;
+}
+
+void IfConversion::convert(Function &func, const Diamond &d) {
+  ValueId term = func.terminator(d.head);
+  ValueId cond = func[term].ops[0];
+  for (auto arm : d.arms) {
+    if (arm == kNoBlock) continue;
+    auto insts = func.blocks[arm].insts;
+    insts.pop_back();
+    for (auto id : insts) {
+      func.detach(id);
+      func.insert_before(term, id);
+    }
+  }
+  for (auto id : func.blocks[d.join].insts) {
+    if (func[id].op != Opcode::Phi) break;
+    ValueId on_true = func.incoming(id, d.from(0));
+    ValueId on_false = func.incoming(id, d.from(1));
+    ValueId value = on_true;
+    if (on_true != on_false) {
+      value = func.create(Opcode::Select, Type::I32, {cond, on_true, on_false});
+      func.insert_before(term, value);
+      selects++;
+    }
+    for (auto arm : d.arms)
+      if (arm != kNoBlock) func.remove_incoming(id, arm);
+    func.remove_incoming(id, d.head);
+    func.add_incoming(id, value, d.head);
+  }
+  func.detach(term);
+  func.append(d.head, func.create(Opcode::Br, Type::Void, {}, {d.join}));
+  for (auto arm : d.arms)
+    if (arm != kNoBlock) func.remove_block(arm);
+  converted++;
+}
+
+}  // namespace IR
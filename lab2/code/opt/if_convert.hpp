@@ -0,0 +1,53 @@
+#ifndef OPT_IF_CONVERT_HPP
+#define OPT_IF_CONVERT_HPP
+
+#include "analysis/cfg.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief If-conversion. A branch whose arms only compute values and then
+/// meet again, as in `if (a[i] > m) m = a[i];`, is replaced by running the
+/// arms unconditionally and choosing the results with `select`. This
+/// trades a branch that may be mispredicted for a few extra instructions,
+/// so it is done only when the arms plus the selects cost at most
+/// kMaxCost. Arms that store or call are never speculated, and loads only
+/// when `head` has already accessed the same address.
+class IfConversion : public FunctionPass {
+ public:
+  /// @brief Roughly the cost of a mispredicted branch in instructions
+  static constexpr int kMaxCost = 6;
+
+  const char *name() const override { return "ifcvt"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Function &func, AnalysisManager &am) override;
+
+ private:
+  int converted = 0;
+  int selects = 0;
+
+  /// @brief A conditional branch in `head` whose edges meet in `join`
+  struct Diamond {
+    BlockId head;
+    BlockId join;
+    /// @brief The blocks on the true and the false edge, kNoBlock when the
+    /// edge goes straight to `join`
+    BlockId arms[2];
+    /// @brief The predecessor of `join` on each side
+    BlockId from(int side) const {
+      return arms[side] == kNoBlock ? head : arms[side];
+    }
+  };
+
+  static bool match(const Function &func, const CFG &cfg, BlockId bb,
+                    Diamond &d);
+  /// @brief Whether `inst` of an arm of `head` can run at the end of `head`
+  /// on both paths
+  static bool speculatable(const Function &func, BlockId head, ValueId inst);
+  static int cost(const Function &func, const Diamond &d);
+  void convert(Function &func, const Diamond &d);
+};
+
+}  // namespace IR
+
+#endif  // OPT_IF_CONVERT_HPP
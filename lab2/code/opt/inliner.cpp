@@ -0,0 +1,184 @@
+#include "inliner.hpp"
+
+#include <algorithm>
+
+namespace IR {
+
+std::string Inliner::stats() const {
+  int total = 0;
+  std::string sites;
+  for (auto &[edge, count] : inlined) {
+    total += count;
+    sites += (sites.empty() ? "" : ", ") + edge.first + "->" + edge.second;
+    if (count > 1) sites += " x" + std::to_string(count);
+  }
+  std::string result = "inlined " + std::to_string(total) + " call sites";
+  if (!sites.empty()) result += " (" + sites + ")";
+  return result + ", deleted " + std::to_string(deleted) + " functions";
+}
+
+PreservedAnalyses Inliner::run(Module &module, AnalysisManager &am) {
+  CallGraph cg(module);
+  bool changed = false;
+  for (auto &scc : cg.sccs)
+    for (auto f : scc) {
+      auto &caller = *module.functions[f];
+      if (caller.is_external || cg.call_sites[f].empty()) continue;
+      // 调用点所在的循环深度在改写之前一次算好
+      auto &loops = am.loops(caller);
+      std::vector<std::pair<ValueId, int>> sites;
+      for (auto call : cg.call_sites[f])
+        sites.emplace_back(call, loops.depth(caller[call].block));
+      bool inlined_any = false;
+      for (auto [call, depth] : sites) {
+        int g = caller[call].imm;
+        auto &callee = *module.functions[g];
+        if (callee.is_external || cg.recursive(g) || !inlinable(callee))
+          continue;
+        if (size(caller) + size(callee) > kMaxCallerSize) continue;
+        if (cost(caller, call, callee, cg, g, depth) > threshold) continue;
+        inlineCall(caller, call, callee);
+        inlined[{callee.name, caller.name}]++;
+        inlined_any = true;
+      }
+      if (!inlined_any) continue;
+      caller.remove_unreachable_blocks();
+      am.invalidate(caller, PreservedAnalyses::none());
+      changed = true;
+    }
+  if (!changed) return PreservedAnalyses::all();
+  removeDeadFunctions(module);
+  return PreservedAnalyses::none();
+}
+
+int Inliner::size(const Function &func) {
+  int n = 0;
+  for (auto &block : func.blocks)
+    for (auto id : block.insts) {
+      auto op = func[id].op;
+      // phi 和无条件跳转在寄存器分配和块布局之后大多会消失
+      if (op != Opcode::Phi && op != Opcode::Br) n++;
+    }
+  return n;
+}
+
+int Inliner::cost(const Function &caller, ValueId call, const Function &callee,
+                  const CallGraph &cg, int callee_index, int depth) const {
+  auto &inst = caller[call];
+  // 调用本身：传参、跳转、保存寄存器、返回
+  int benefit = 5 + 2 * inst.num_ops;
+  for (uint32_t i = 0; i < inst.num_ops; i++)
+    if (caller.is_const(inst.ops[i])) benefit += 5;
+  // 唯一的调用点内联后原函数可以删除，代码不会变大
+  if (cg.num_calls(callee_index) == 1 && callee.name != "main") benefit += 30;
+  benefit += 10 * std::min(depth, 3);
+  return size(callee) - benefit;
+}
+
+bool Inliner::inlinable(const Function &callee) {
+  // 入口块有前驱时，其 phi 无法再接收来自调用点的边
+  for (auto id : callee.blocks[0].insts)
+    if (callee[id].op == Opcode::Phi) return false;
+  return true;
+}
+
+BlockId Inliner::splitAfter(Function &func, ValueId pos) {
+  BlockId bb = func[pos].block;
+  BlockId tail = func.add_block();
+  auto &insts = func.blocks[bb].insts;
+  auto it = std::find(insts.begin(), insts.end(), pos) + 1;
+  std::vector<ValueId> moved(it, insts.end());
+  func.blocks[bb].insts.erase(it, insts.end());
+  for (auto id : moved) func[id].block = tail;
+  func.blocks[tail].insts = std::move(moved);
+  for (auto succ : func.succs(tail)) func.replace_incoming_block(succ, bb, tail);
+  return tail;
+}
+
+void Inliner::inlineCall(Function &caller, ValueId call, const Function &callee) {
+  BlockId bb = caller[call].block;
+  BlockId tail = splitAfter(caller, call);
+
+  std::vector<BlockId> block_map(callee.num_blocks(), kNoBlock);
+  for (BlockId b = 0; b < callee.num_blocks(); b++)
+    if (!callee.blocks[b].removed) block_map[b] = caller.add_block();
+
+  // 形参直接换成实参，数组参数传进来的就是调用方的地址
+  std::vector<ValueId> value_map(callee.insts.size(), kNoValue);
+  for (ValueId v = 0; v < callee.insts.size(); v++) {
+    auto &inst = callee[v];
+    switch (inst.op) {
+      case Opcode::Const: value_map[v] = caller.const_int(inst.imm); break;
+      case Opcode::Arg: value_map[v] = caller[call].ops[inst.imm]; break;
+      case Opcode::Global: value_map[v] = caller.global_addr(inst.imm); break;
+      case Opcode::Undef: value_map[v] = caller.undef(inst.type); break;
+      default: break;
+    }
+  }
+
+  // 先为所有指令分配编号，再统一改写操作数，phi 可以引用后面的值
+  std::vector<std::pair<ValueId, BlockId>> returns;
+  std::vector<ValueId> allocas, cloned;
+  for (BlockId b = 0; b < callee.num_blocks(); b++) {
+    if (callee.blocks[b].removed) continue;
+    for (auto id : callee.blocks[b].insts) {
+      auto &inst = callee[id];
+      if (inst.op == Opcode::Ret) {
+        if (inst.num_ops) returns.emplace_back(inst.ops[0], block_map[b]);
+        auto br = caller.create(Opcode::Br, Type::Void, {}, {tail});
+        caller.append(block_map[b], br);
+        continue;
+      }
+      std::vector<ValueId> ops(inst.ops, inst.ops + inst.num_ops);
+      std::vector<BlockId> targets;
+      for (uint32_t i = 0; i < inst.num_targets; i++)
+        targets.push_back(block_map[inst.targets[i]]);
+      ValueId copy = caller.create(inst.op, inst.type, ops, targets, inst.imm);
+      // 内联后被调函数返回之后还要回到调用方，尾调用不再成立
+      caller[copy].flags = inst.flags & ~kCallTail;
+      value_map[id] = copy;
+      cloned.push_back(copy);
+      auto name = callee.names.find(id);
+      if (name != callee.names.end())
+        caller.names[copy] = name->second + "." + std::to_string(copy);
+      // 栈槽放到调用方入口，保证 alloca 都在入口块
+      if (inst.op == Opcode::Alloca)
+        allocas.push_back(copy);
+      else
+        caller.append(block_map[b], copy);
+    }
+  }
+  for (auto copy : cloned) {
+    auto &inst = caller[copy];
+    for (uint32_t i = 0; i < inst.num_ops; i++)
+      inst.ops[i] = value_map[inst.ops[i]];
+  }
+  auto &entry = caller.blocks[0].insts;
+  for (auto alloca : allocas) caller[alloca].block = 0;
+  entry.insert(entry.begin(), allocas.begin(), allocas.end());
+
+  // 返回值在续块汇合
+  if (caller[call].type != Type::Void) {
+    ValueId result = caller.undef(caller[call].type);
+    if (returns.size() == 1) {
+      result = value_map[returns[0].first];
+    } else if (returns.size() > 1) {
+      result = caller.create(Opcode::Phi, caller[call].type);
+      for (auto &[value, from] : returns)
+        caller.add_incoming(result, value_map[value], from);
+      caller.insert_after_phis(tail, result);
+    }
+    caller.replace_all_uses(call, result);
+  }
+  caller.detach(call);
+  auto br = caller.create(Opcode::Br, Type::Void, {}, {block_map[0]});
+  caller.append(bb, br);
+}
+
+void Inliner::removeDeadFunctions(Module &module) {
+  auto dead = CallGraph(module).unreachable(module);
+  deleted += std::count(dead.begin(), dead.end(), true);
+  module.remove_functions(dead);
+}
+
+}  // namespace IR
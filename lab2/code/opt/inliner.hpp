@@ -0,0 +1,56 @@
+#ifndef OPT_INLINER_HPP
+#define OPT_INLINER_HPP
+
+#include <map>
+#include <utility>
+
+#include "analysis/call_graph.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Replaces calls by a copy of the callee's body. Functions are
+/// visited callees first, so a body is copied after its own calls have
+/// been inlined. A call site is inlined when the size of the callee minus
+/// the expected benefit (the call itself, constant arguments, being the
+/// only call, sitting in a loop) does not exceed the threshold. Recursive
+/// functions are never inlined, and functions left without callers are
+/// deleted.
+class Inliner : public ModulePass {
+ public:
+  explicit Inliner(int threshold = 40) : threshold(threshold) {}
+
+  const char *name() const override { return "inline"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Module &module, AnalysisManager &am) override;
+
+  /// @brief The number of instructions that will remain after lowering
+  static int size(const Function &func);
+
+ private:
+  /// @brief The largest cost that is still inlined
+  int threshold;
+  /// @brief Callers never grow beyond this many instructions
+  static constexpr int kMaxCallerSize = 4000;
+
+  /// @brief The number of call sites inlined for each (callee, caller)
+  std::map<std::pair<std::string, std::string>, int> inlined;
+  int deleted = 0;
+
+  /// @brief The size of `callee` minus the benefit of inlining `call`
+  int cost(const Function &caller, ValueId call, const Function &callee,
+           const CallGraph &cg, int callee_index, int depth) const;
+  /// @brief Whether the body of `callee` can be copied at all
+  static bool inlinable(const Function &callee);
+  /// @brief Replace `call` by a copy of the body of `callee`
+  void inlineCall(Function &caller, ValueId call, const Function &callee);
+  /// @brief Move the instructions after `pos` to a new block, which also
+  /// takes over the outgoing edges
+  BlockId splitAfter(Function &func, ValueId pos);
+  /// @brief Delete the internal functions that are no longer called
+  void removeDeadFunctions(Module &module);
+};
+
+}  // namespace IR
+
+#endif  // OPT_INLINER_HPP
@@ -0,0 +1,228 @@
+#include "ipcp.hpp"
+
+#include <algorithm>
+
+#include "analysis/call_graph.hpp"
+#include "opt/inliner.hpp"
+#include "opt/sccp.hpp"
+#include "opt/simplify_cfg.hpp"
+
+namespace IR {
+
+std::string IPConstProp::stats() const {
+  std::string res = "propagated " + std::to_string(propagated) +
+                    " constant parameters, created " +
+                    std::to_string(clones.size()) + " clones";
+  std::string list;
+  for (auto &clone : clones) list += (list.empty() ? "" : ", ") + clone;
+  if (!list.empty()) res += " (" + list + ")";
+  return res + " for " + std::to_string(redirected) + " calls, deleted " +
+         std::to_string(deleted) + " functions";
+}
+
+PreservedAnalyses IPConstProp::run(Module &module, AnalysisManager &) {
+  bool changed = propagate(module);
+  if (specialize(module)) {
+    changed = true;
+    // 所有调用都换成克隆后原函数就不再需要
+    auto dead = CallGraph(module).unreachable(module);
+    deleted += std::count(dead.begin(), dead.end(), true);
+    module.remove_functions(dead);
+  }
+  return changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+}
+
+bool IPConstProp::propagate(Module &module) {
+  bool changed_any = false, changed = true;
+  // 替换后调用方传给下一层的实参也可能变成常量
+  while (changed) {
+    changed = false;
+    CallGraph cg(module);
+    std::vector<std::vector<std::pair<int, ValueId>>> sites(
+        module.functions.size());
+    for (size_t f = 0; f < module.functions.size(); f++)
+      for (auto call : cg.call_sites[f])
+        sites[(*module.functions[f])[call].imm].emplace_back(f, call);
+    for (size_t g = 0; g < module.functions.size(); g++) {
+      auto &callee = *module.functions[g];
+      if (callee.is_external || sites[g].empty()) continue;
+      for (size_t i = 0; i < callee.args.size(); i++) {
+        if (callee.param_types[i] != Type::I32) continue;
+        std::optional<int> value;
+        bool same = true;
+        for (auto [f, call] : sites[g]) {
+          auto &caller = *module.functions[f];
+          ValueId arg = caller[call].ops[i];
+          if (f == (int)g && arg == callee.args[i]) continue;
+          if (!caller.is_const(arg) || (value && *value != caller[arg].imm)) {
+            same = false;
+            break;
+          }
+          value = caller[arg].imm;
+        }
+        if (!same || !value) continue;
+        // 形参仍然保留，调用方照常传值
+        bool used = false;
+        for (auto &block : callee.blocks)
+          for (auto id : block.insts)
+            for (uint32_t k = 0; k < callee[id].num_ops; k++)
+              used |= callee[id].ops[k] == callee.args[i];
+        if (!used) continue;
+        callee.replace_all_uses(callee.args[i], callee.const_int(*value));
+        propagated++;
+        changed = changed_any = true;
+      }
+    }
+  }
+  return changed_any;
+}
+
+bool IPConstProp::specialize(Module &module) {
+  // 新建的克隆中的调用也会加入工作表，递归调用可以指向克隆自身
+  std::vector<std::pair<int, ValueId>> worklist;
+  size_t n = module.functions.size();
+  for (size_t f = 0; f < n; f++) {
+    auto &func = *module.functions[f];
+    for (auto &block : func.blocks)
+      for (auto id : block.insts)
+        if (func[id].op == Opcode::Call) worklist.emplace_back(f, id);
+  }
+  // 每种特化的克隆编号，-1 表示不划算
+  std::map<std::pair<int, ConstArgs>, int> specialized;
+  std::map<std::string, int> counters;
+  // 克隆由哪个函数和哪组常量得到，原函数的常量为空
+  std::vector<std::pair<int, ConstArgs>> made_from;
+  for (size_t f = 0; f < n; f++) made_from.emplace_back(f, ConstArgs());
+  CallGraph cg(module);
+  auto scc_of = [&](int f) {
+    while (f >= (int)n) f = made_from[f].first;
+    return cg.scc_of[f];
+  };
+  bool changed = false;
+  for (size_t k = 0; k < worklist.size(); k++) {
+    auto [f, call] = worklist[k];
+    auto &caller = *module.functions[f];
+    int g = caller[call].imm;
+    auto &callee = *module.functions[g];
+    if (callee.is_external || callee.name == "main") continue;
+    ConstArgs args(callee.args.size());
+    bool any = false;
+    for (size_t i = 0; i < args.size(); i++) {
+      ValueId arg = caller[call].ops[i];
+      if (callee.param_types[i] != Type::I32 || !caller.is_const(arg))
+        continue;
+      args[i] = caller[arg].imm;
+      any = true;
+    }
+    if (!any) continue;
+
+    auto key = std::make_pair(g, args);
+    // 克隆里的递归调用只能指向克隆自身，否则常量递归如 fib(24) 会展开成
+    // fib(23)、fib(22) ... 一串克隆，调用次数一点也没有减少
+    if (f >= (int)n && scc_of(f) == scc_of(g) && made_from[f] != key)
+      continue;
+    auto it = specialized.find(key);
+    if (it == specialized.end()) {
+      std::string name =
+          callee.name + "." + std::to_string(++counters[callee.name]);
+      auto copy = clone(callee, name, args);
+      int size = Inliner::size(*copy), saving = Inliner::size(callee) - size;
+      int index = -1;
+      if (size <= budget && saving >= kMinSaving &&
+          saving * 100 >= kMinSavingPercent * Inliner::size(callee)) {
+        index = module.add_function(copy);
+        made_from.push_back(key);
+        budget -= size;
+        clones.push_back(describe(name, callee, args));
+        for (auto &block : copy->blocks)
+          for (auto id : block.insts)
+            if ((*copy)[id].op == Opcode::Call)
+              worklist.emplace_back(index, id);
+      } else {
+        counters[callee.name]--;
+      }
+      it = specialized.emplace(key, index).first;
+    }
+    if (it->second < 0) continue;
+
+    std::vector<ValueId> ops;
+    for (size_t i = 0; i < args.size(); i++)
+      if (!args[i]) ops.push_back(caller[call].ops[i]);
+    ValueId redirect =
+        caller.create(Opcode::Call, caller[call].type, ops, {}, it->second);
+    caller[redirect].flags = caller[call].flags;
+    caller.insert_before(call, redirect);
+    caller.replace_all_uses(call, redirect);
+    caller.detach(call);
+    redirected++;
+    changed = true;
+  }
+  return changed;
+}
+
+FunctionPtr IPConstProp::clone(const Function &func, const std::string &name,
+                               const ConstArgs &args) {
+  std::vector<Type> params;
+  for (size_t i = 0; i < args.size(); i++)
+    if (!args[i]) params.push_back(func.param_types[i]);
+  auto copy = Function::create(name, func.ret_type, params);
+  for (BlockId b = 0; b < func.num_blocks(); b++) {
+    copy->add_block();
+    copy->blocks[b].removed = func.blocks[b].removed;
+  }
+
+  std::vector<ValueId> value_map(func.insts.size(), kNoValue);
+  size_t next_arg = 0;
+  for (ValueId v = 0; v < func.insts.size(); v++) {
+    auto &inst = func[v];
+    switch (inst.op) {
+      case Opcode::Const: value_map[v] = copy->const_int(inst.imm); break;
+      case Opcode::Global: value_map[v] = copy->global_addr(inst.imm); break;
+      case Opcode::Undef: value_map[v] = copy->undef(inst.type); break;
+      case Opcode::Arg:
+        value_map[v] = args[inst.imm] ? copy->const_int(*args[inst.imm])
+                                      : copy->args[next_arg++];
+        break;
+      default: break;
+    }
+  }
+  // 块编号不变，先复制指令再统一改写操作数
+  std::vector<ValueId> cloned;
+  for (BlockId b = 0; b < func.num_blocks(); b++)
+    for (auto id : func.blocks[b].insts) {
+      auto &inst = func[id];
+      std::vector<ValueId> ops(inst.ops, inst.ops + inst.num_ops);
+      std::vector<BlockId> targets(inst.targets,
+                                   inst.targets + inst.num_targets);
+      ValueId v = copy->create(inst.op, inst.type, ops, targets, inst.imm);
+      (*copy)[v].flags = inst.flags;
+      copy->append(b, v);
+      value_map[id] = v;
+      cloned.push_back(v);
+      auto it = func.names.find(id);
+      if (it != func.names.end()) copy->names[v] = it->second;
+    }
+  for (auto v : cloned) {
+    auto &inst = (*copy)[v];
+    for (uint32_t i = 0; i < inst.num_ops; i++)
+      inst.ops[i] = value_map[inst.ops[i]];
+  }
+
+  AnalysisManager am;
+  SCCP().run(*copy, am);
+  SimplifyCFG().run(*copy, am);
+  return copy;
+}
+
+std::string IPConstProp::describe(const std::string &clone,
+                                  const Function &func,
+                                  const ConstArgs &args) {
+  std::string res = clone + " = " + func.name + "(";
+  for (size_t i = 0; i < args.size(); i++) {
+    if (i) res += ", ";
+    res += args[i] ? std::to_string(*args[i]) : "_";
+  }
+  return res + ")";
+}
+
+}  // namespace IR
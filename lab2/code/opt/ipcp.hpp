@@ -0,0 +1,65 @@
+#ifndef OPT_IPCP_HPP
+#define OPT_IPCP_HPP
+
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Interprocedural constant propagation. A parameter that receives
+/// the same constant at every call site (recursive calls may also pass the
+/// parameter through unchanged) is replaced by that constant inside the
+/// callee. Call sites that pass constants a callee does not always get,
+/// like a mode flag, may instead call a specialized clone without those
+/// parameters. A clone is kept only if folding the constants shrinks it by
+/// a useful amount, and all clones together stay within a budget of
+/// instructions. Identical specializations share one clone. Calls from a
+/// clone back into its own recursive cycle are not specialized again; a
+/// recursive call goes to the clone itself only when it passes the same
+/// constants.
+class IPConstProp : public ModulePass {
+ public:
+  explicit IPConstProp(int budget = 400) : budget(budget) {}
+
+  const char *name() const override { return "ipcp"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Module &module, AnalysisManager &am) override;
+
+ private:
+  /// @brief The constant arguments of a call, nullopt where not constant
+  using ConstArgs = std::vector<std::optional<int>>;
+
+  /// @brief The total size of the clones that may still be created
+  int budget;
+  /// @brief A clone is kept only if folding removes at least this many
+  /// instructions and this share of the original
+  static constexpr int kMinSaving = 4;
+  static constexpr int kMinSavingPercent = 10;
+
+  int propagated = 0;
+  int redirected = 0;
+  int deleted = 0;
+  /// @brief Descriptions of the clones, e.g. "solve.1 = solve(_, 100, 1)"
+  std::vector<std::string> clones;
+
+  /// @brief Replace parameters that are the same constant at every call
+  /// site, until nothing changes
+  bool propagate(Module &module);
+  /// @brief Redirect calls with constant arguments to profitable clones
+  bool specialize(Module &module);
+  /// @brief A copy of `func` with the parameters in `args` replaced by the
+  /// constants and removed, folded with sccp and simplifycfg
+  static FunctionPtr clone(const Function &func, const std::string &name,
+                           const ConstArgs &args);
+  static std::string describe(const std::string &clone,
+                              const Function &func, const ConstArgs &args);
+};
+
+}  // namespace IR
+
+#endif  // OPT_IPCP_HPP
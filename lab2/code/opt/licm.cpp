@@ -0,0 +1,88 @@
+#include "licm.hpp"
+
+#include <algorithm>
+
+namespace IR {
+
+std::string LICM::stats() const {
+  return "hoisted " + std::to_string(hoisted) + " instructions (" +
+         std::to_string(hoisted_loads) + " loads)";
+}
+
+PreservedAnalyses LICM::run(Function &func, AnalysisManager &am) {
+  auto &cfg = am.cfg(func);
+  auto &dom = am.dominators(func);
+  auto &loops = am.loops(func);
+  if (loops.loops().empty()) return PreservedAnalyses::all();
+  AliasAnalysis aa(func);
+  int before = hoisted;
+
+  for (auto loop : loops.loops()) {
+    if (loop->preheader == kNoBlock) continue;
+    auto invariant = [&](ValueId v) {
+      return func[v].block == kNoBlock || !loops.contains(loop, func[v].block);
+    };
+    // 每次迭代都会执行的块：支配所有离开循环的块
+    auto always_runs = [&](BlockId bb) {
+      return std::all_of(loop->exiting.begin(), loop->exiting.end(),
+                         [&](BlockId e) { return dom.dominates(bb, e); });
+    };
+    // 按逆后序访问，被提升的操作数先于使用它的指令
+    for (auto bb : cfg.rpo) {
+      if (!loops.contains(loop, bb)) continue;
+      auto insts = func.blocks[bb].insts;
+      for (auto id : insts) {
+        auto &inst = func[id];
+        bool candidate = is_binary(inst.op) || inst.op == Opcode::Gep ||
+                         inst.op == Opcode::Select || inst.op == Opcode::Load;
+        if (!candidate) continue;
+        if (!std::all_of(inst.ops, inst.ops + inst.num_ops, invariant))
+          continue;
+        if (!speculatable(func, aa, id) && !always_runs(bb)) continue;
+        if (inst.op == Opcode::Load && clobbered(func, aa, *loop, id))
+          continue;
+        func.detach(id);
+        func.insert_before_terminator(loop->preheader, id);
+        hoisted++;
+        if (inst.op == Opcode::Load) hoisted_loads++;
+      }
+    }
+  }
+  if (hoisted == before) return PreservedAnalyses::all();
+  // 只移动了指令，控制流不变
+  return PreservedAnalyses::none()
+      .preserve(AnalysisKind::CFG)
+      .preserve(AnalysisKind::Dominators)
+      .preserve(AnalysisKind::Loops);
+}
+
+bool LICM::speculatable(const Function &func, const AliasAnalysis &aa,
+                        ValueId inst) {
+  auto &i = func[inst];
+  if (i.op == Opcode::Div || i.op == Opcode::Mod) {
+    // 除零和 INT_MIN / -1 都会出错
+    ValueId divisor = i.ops[1];
+    return func.is_const(divisor) && func[divisor].imm != 0 &&
+           func[divisor].imm != -1;
+  }
+  if (i.op != Opcode::Load) return true;
+  // 只有确定落在栈槽或全局变量范围内的地址才能提前读取
+  ValueId ptr = i.ops[0], obj = aa.object(ptr);
+  auto offset = aa.offset(ptr);
+  if (obj == kNoValue || !offset || *offset < 0) return false;
+  auto &o = func[obj];
+  if (o.op == Opcode::Alloca) return *offset < o.imm;
+  // 全局变量至少有一个元素
+  return o.op == Opcode::Global && *offset == 0;
+}
+
+bool LICM::clobbered(const Function &func, const AliasAnalysis &aa,
+                     const Loop &loop, ValueId load) {
+  ValueId ptr = func[load].ops[0];
+  for (auto bb : loop.blocks)
+    for (auto id : func.blocks[bb].insts)
+      if (aa.may_write(id, ptr)) return true;
+  return false;
+}
+
+}  // namespace IR
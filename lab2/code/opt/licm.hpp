@@ -0,0 +1,38 @@
+#ifndef OPT_LICM_HPP
+#define OPT_LICM_HPP
+
+#include "analysis/alias.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Loop-invariant code motion. An instruction whose operands are all
+/// defined outside a loop computes the same value on every iteration and
+/// is moved to the preheader, inner loops first so that values can climb
+/// out of a whole nest. Loads are hoisted only when no store or call in
+/// the loop may write the element, and only when reading it early cannot
+/// fault. Division is never speculated unless the divisor is a safe
+/// constant. Loops without a preheader are left alone, run loop-simplify
+/// first.
+class LICM : public FunctionPass {
+ public:
+  const char *name() const override { return "licm"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Function &func, AnalysisManager &am) override;
+
+ private:
+  int hoisted = 0;
+  int hoisted_loads = 0;
+
+  /// @brief Whether `inst` may be executed on paths that did not execute
+  /// it before
+  static bool speculatable(const Function &func, const AliasAnalysis &aa,
+                           ValueId inst);
+  /// @brief Whether anything in `loop` may write the element `load` reads
+  static bool clobbered(const Function &func, const AliasAnalysis &aa,
+                        const Loop &loop, ValueId load);
+};
+
+}  // namespace IR
+
+#endif  // OPT_LICM_HPP
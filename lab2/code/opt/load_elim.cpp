@@ -0,0 +1,109 @@
+#include "load_elim.hpp"
+
+#include <algorithm>
+
+namespace IR {
+
+std::string RedundantLoadElim::stats() const {
+  return "forwarded " + std::to_string(forwarded) + " loads";
+}
+
+PreservedAnalyses RedundantLoadElim::run(Module &module,
+                                         AnalysisManager &am) {
+  ModuleAliasInfo info(module);
+  // 只删除了 load，控制流不变
+  auto kept = PreservedAnalyses::none()
+                  .preserve(AnalysisKind::CFG)
+                  .preserve(AnalysisKind::Dominators)
+                  .preserve(AnalysisKind::Loops);
+  bool changed = false;
+  for (size_t index = 0; index < module.functions.size(); index++) {
+    auto &func = *module.functions[index];
+    if (func.is_external) continue;
+    AliasAnalysis aa(func, info, index);
+    if (!runOnFunction(func, am.cfg(func), aa)) continue;
+    am.invalidate(func, kept);
+    changed = true;
+  }
+  return changed ? kept : PreservedAnalyses::all();
+}
+
+bool RedundantLoadElim::runOnFunction(Function &func, const CFG &cfg,
+                                      const AliasAnalysis &aa) {
+  std::vector<Known> out(func.num_blocks());
+  // 被替换的 load 到替代值，操作数在访问时改写，最后再补上回边的使用
+  std::vector<ValueId> replacement(func.insts.size(), kNoValue);
+  auto resolve = [&](ValueId v) {
+    return replacement[v] == kNoValue ? v : replacement[v];
+  };
+  bool changed = false;
+  for (auto bb : cfg.rpo) {
+    // 所有前驱都一致的内容才是已知的；还没访问过的前驱来自回边
+    Known known;
+    auto &preds = cfg.preds[bb];
+    bool all_seen = !preds.empty();
+    for (auto pred : preds)
+      all_seen &= cfg.reachable(pred) &&
+                  cfg.rpo_index[pred] < cfg.rpo_index[bb];
+    if (all_seen) {
+      known = out[preds[0]];
+      for (size_t i = 1; i < preds.size(); i++) {
+        auto &other = out[preds[i]];
+        known.erase(std::remove_if(known.begin(), known.end(),
+                                   [&](const auto &pair) {
+                                     return std::find(other.begin(),
+                                                      other.end(), pair) ==
+                                            other.end();
+                                   }),
+                    known.end());
+      }
+    }
+    auto forget = [&](auto clobbers) {
+      known.erase(std::remove_if(known.begin(), known.end(), clobbers),
+                  known.end());
+    };
+    auto remember = [&](ValueId ptr, ValueId value) {
+      if (known.size() == kMaxKnown) known.erase(known.begin());
+      known.emplace_back(ptr, value);
+    };
+
+    for (auto id : func.blocks[bb].insts) {
+      auto &inst = func[id];
+      for (uint32_t i = 0; i < inst.num_ops; i++)
+        inst.ops[i] = resolve(inst.ops[i]);
+      if (inst.op == Opcode::Load) {
+        ValueId ptr = inst.ops[0];
+        auto it = std::find_if(known.begin(), known.end(), [&](auto &pair) {
+          return aa.must_alias(pair.first, ptr);
+        });
+        if (it == known.end()) {
+          remember(ptr, id);
+          continue;
+        }
+        replacement[id] = it->second;
+        forwarded++;
+        changed = true;
+      } else if (inst.op == Opcode::Store) {
+        ValueId ptr = inst.ops[1];
+        forget([&](auto &pair) { return aa.may_alias(pair.first, ptr); });
+        remember(ptr, inst.ops[0]);
+      } else if (inst.op == Opcode::Call) {
+        forget([&](auto &pair) { return aa.may_write(id, pair.first); });
+      }
+    }
+    out[bb] = std::move(known);
+  }
+  if (!changed) return false;
+  std::vector<bool> dead(func.insts.size(), false);
+  for (auto &block : func.blocks)
+    for (auto id : block.insts) {
+      auto &inst = func[id];
+      for (uint32_t i = 0; i < inst.num_ops; i++)
+        inst.ops[i] = resolve(inst.ops[i]);
+      dead[id] = replacement[id] != kNoValue;
+    }
+  func.remove_insts(dead);
+  return true;
+}
+
+}  // namespace IR
@@ -0,0 +1,42 @@
+#ifndef OPT_LOAD_ELIM_HPP
+#define OPT_LOAD_ELIM_HPP
+
+#include <utility>
+#include <vector>
+
+#include "analysis/alias.hpp"
+#include "analysis/cfg.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Redundant load elimination. Walks the blocks in reverse postorder
+/// keeping the known contents of memory as (address, value) pairs: a store
+/// makes its value known, a load makes its result known, and a store or
+/// call that may write an address forgets it. A load from an address that
+/// always points to a known element is replaced by the value. A block
+/// keeps the pairs all of its predecessors agree on; a loop header starts
+/// empty since its back edge has not been seen. Alias queries use the
+/// ModuleAliasInfo of the module, so a store through one array parameter
+/// keeps loads from another array that is never passed for it.
+class RedundantLoadElim : public ModulePass {
+ public:
+  /// @brief The most pairs kept at a time, the oldest are dropped first
+  static constexpr size_t kMaxKnown = 64;
+
+  const char *name() const override { return "load-elim"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Module &module, AnalysisManager &am) override;
+
+ private:
+  using Known = std::vector<std::pair<ValueId, ValueId>>;
+
+  int forwarded = 0;
+
+  /// @return whether any load was replaced
+  bool runOnFunction(Function &func, const CFG &cfg, const AliasAnalysis &aa);
+};
+
+}  // namespace IR
+
+#endif  // OPT_LOAD_ELIM_HPP
@@ -0,0 +1,230 @@
+#include "loop_interchange.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <tuple>
+
+namespace IR {
+
+std::string LoopInterchange::stats() const {
+  std::string list;
+  for (auto &nest : nests) list += (list.empty() ? "" : ", ") + nest;
+  std::string result =
+      "interchanged " + std::to_string(interchanged) + " loop nests";
+  if (!list.empty()) result += " (" + list + ")";
+  return result;
+}
+
+PreservedAnalyses LoopInterchange::run(Function &func, AnalysisManager &am) {
+  auto &loops = am.loops(func);
+  AliasAnalysis aa(func);
+  bool changed = false;
+  for (auto loop : loops.loops())
+    if (tryInterchange(func, loops, *loop, aa)) {
+      nests.push_back(func.name + ":bb" + std::to_string(loop->header));
+      interchanged++;
+      changed = true;
+    }
+  if (!changed) return PreservedAnalyses::all();
+  // 只改写了归纳变量和比较，控制流不变
+  return PreservedAnalyses::none()
+      .preserve(AnalysisKind::CFG)
+      .preserve(AnalysisKind::Dominators)
+      .preserve(AnalysisKind::Loops);
+}
+
+static std::vector<std::vector<ValueId>> collectUsers(const Function &func) {
+  std::vector<std::vector<ValueId>> users(func.insts.size());
+  for (auto &block : func.blocks)
+    for (auto id : block.insts)
+      for (uint32_t i = 0; i < func[id].num_ops; i++)
+        users[func[id].ops[i]].push_back(id);
+  return users;
+}
+
+static void setIncoming(Function &func, ValueId phi, BlockId from, ValueId value) {
+  for (uint32_t i = 0; i < func[phi].num_ops; i++)
+    if (func[phi].targets[i] == from) func.set_operand(phi, i, value);
+}
+
+bool LoopInterchange::tryInterchange(Function &func, const LoopInfo &loops,
+                                     const Loop &outer,
+                                     const AliasAnalysis &aa) {
+  if (outer.children.size() != 1) return false;
+  const Loop &inner = *outer.children[0];
+  if (!inner.children.empty() || outer.preheader == kNoBlock ||
+      inner.preheader == kNoBlock || outer.latches.size() != 1 ||
+      inner.latches.size() != 1)
+    return false;
+  InductionInfo oi(func, loops, outer), ii(func, loops, inner);
+  auto otest = oi.exit_test(), itest = ii.exit_test();
+  if (!otest || !itest) return false;
+  auto &ov = oi.ivs()[otest->iv];
+  auto &iv = ii.ivs()[itest->iv];
+
+  // 交换后每个循环都要能自行结束：次数已知，或严格比较且步长为 1
+  auto terminates = [&](const InductionInfo &ind, const ExitTest &test) {
+    bool strict = test.op == Opcode::Lt || test.op == Opcode::Gt;
+    return ind.trip_count() || (strict && std::abs(ind.ivs()[test.iv].step) == 1);
+  };
+  if (!terminates(oi, *otest) || !terminates(ii, *itest)) return false;
+  if (!oi.invariant(iv.init) || !oi.invariant(itest->bound)) return false;
+
+  // 内层循环之外只能有循环控制
+  for (auto bb : outer.blocks) {
+    if (loops.contains(&inner, bb)) continue;
+    for (auto id : func.blocks[bb].insts) {
+      auto op = func[id].op;
+      if (id == ov.next || id == otest->cmp || op == Opcode::Br) continue;
+      if (bb == outer.header &&
+          (op == Opcode::Phi || id == func.terminator(bb)))
+        continue;
+      return false;
+    }
+  }
+  auto users = collectUsers(func);
+  auto used_only_by = [&](ValueId v, auto allowed) {
+    return std::all_of(users[v].begin(), users[v].end(), allowed);
+  };
+  auto in_inner = [&](ValueId u) {
+    return func[u].block != kNoBlock && loops.contains(&inner, func[u].block);
+  };
+  if (!used_only_by(ov.phi, [&](ValueId u) {
+        return u == ov.next || u == otest->cmp || in_inner(u);
+      }) ||
+      !used_only_by(iv.phi, [&](ValueId u) {
+        return u == iv.next || u == itest->cmp || in_inner(u);
+      }) ||
+      !used_only_by(ov.next, [&](ValueId u) { return u == ov.phi; }) ||
+      !used_only_by(iv.next, [&](ValueId u) { return u == iv.phi; }))
+    return false;
+  if (!onlyReductions(func, outer, inner, ov.phi, iv.phi, users)) return false;
+
+  // 收集内层的访存，下标按两个归纳变量和外层不变量线性展开
+  auto atom = [&](ValueId v) {
+    return v == ov.phi || v == iv.phi || oi.invariant(v);
+  };
+  std::vector<Access> accesses;
+  for (auto bb : inner.blocks)
+    for (auto id : func.blocks[bb].insts) {
+      auto &inst = func[id];
+      if (inst.op == Opcode::Call) return false;
+      if (inst.op != Opcode::Load && inst.op != Opcode::Store) continue;
+      Access access;
+      access.store = inst.op == Opcode::Store;
+      access.ptr = inst.ops[access.store ? 1 : 0];
+      access.base = access.ptr;
+      std::optional<LinearIndex> index = LinearIndex();
+      if (func[access.ptr].op == Opcode::Gep) {
+        access.base = func[access.ptr].ops[0];
+        index = linear_index(func, func[access.ptr].ops[1], atom);
+      }
+      if (!index || !oi.invariant(access.base)) return false;
+      access.index = *index;
+      accesses.push_back(access);
+    }
+
+  // 只有内层步幅更大时才值得交换
+  int64_t outer_stride = 0, inner_stride = 0;
+  for (auto &access : accesses) {
+    outer_stride += std::abs(access.index.coefficient(ov.phi) * ov.step);
+    inner_stride += std::abs(access.index.coefficient(iv.phi) * iv.step);
+  }
+  if (outer_stride >= inner_stride) return false;
+
+  std::vector<LoopDimension> dims = {{ov.phi, ov.step, oi.trip_count()},
+                                     {iv.phi, iv.step, ii.trip_count()}};
+  if (reversesDependence(accesses, dims, aa)) return false;
+
+  // 交换两个变量的起点、步长和边界，并在循环体中互换它们的使用
+  ValueId ov_init = ov.init, iv_init = iv.init;
+  setIncoming(func, ov.phi, outer.preheader, iv_init);
+  setIncoming(func, iv.phi, inner.preheader, ov_init);
+  int32_t ov_step = ov.step, iv_step = iv.step;
+  for (auto [next, phi, step] : {std::make_tuple(ov.next, ov.phi, iv_step),
+                                 std::make_tuple(iv.next, iv.phi, ov_step)}) {
+    func[next].op = Opcode::Add;
+    func.set_operand(next, 0, phi);
+    func.set_operand(next, 1, func.const_int(step));
+  }
+  ExitTest o = *otest, i = *itest;
+  func[o.cmp].op = i.op;
+  func.set_operand(o.cmp, 0, ov.phi);
+  func.set_operand(o.cmp, 1, i.bound);
+  func[i.cmp].op = o.op;
+  func.set_operand(i.cmp, 0, iv.phi);
+  func.set_operand(i.cmp, 1, o.bound);
+  for (auto bb : inner.blocks)
+    for (auto id : func.blocks[bb].insts) {
+      if (id == iv.phi || id == iv.next || id == i.cmp) continue;
+      for (uint32_t k = 0; k < func[id].num_ops; k++) {
+        ValueId op = func[id].ops[k];
+        if (op == ov.phi) func.set_operand(id, k, iv.phi);
+        if (op == iv.phi) func.set_operand(id, k, ov.phi);
+      }
+    }
+  return true;
+}
+
+bool LoopInterchange::onlyReductions(
+    const Function &func, const Loop &outer, const Loop &inner, ValueId outer_iv,
+    ValueId inner_iv, const std::vector<std::vector<ValueId>> &users) {
+  auto phis = [&](BlockId bb) {
+    std::vector<ValueId> result;
+    for (auto id : func.blocks[bb].insts)
+      if (func[id].op == Opcode::Phi) result.push_back(id);
+    return result;
+  };
+  auto outer_phis = phis(outer.header), inner_phis = phis(inner.header);
+  if (outer_phis.size() != inner_phis.size()) return false;
+  for (auto r_in : inner_phis) {
+    if (r_in == inner_iv) continue;
+    // 外层的和流入内层，内层累加后流回外层的回边
+    ValueId r_out = func.incoming(r_in, inner.preheader);
+    if (r_out == outer_iv ||
+        std::find(outer_phis.begin(), outer_phis.end(), r_out) == outer_phis.end() ||
+        func.incoming(r_out, outer.latches[0]) != r_in)
+      return false;
+    ValueId next = func.incoming(r_in, inner.latches[0]);
+    auto &inst = func[next];
+    bool sum = (inst.op == Opcode::Add &&
+                (inst.ops[0] == r_in || inst.ops[1] == r_in)) ||
+               (inst.op == Opcode::Sub && inst.ops[0] == r_in);
+    if (!sum || inst.ops[0] == inst.ops[1]) return false;
+    for (auto u : users[r_in])
+      if (u != next && u != r_out) return false;
+    for (auto u : users[next])
+      if (u != r_in) return false;
+    for (auto u : users[r_out])
+      if (u != r_in && func[u].block != kNoBlock &&
+          std::find(outer.blocks.begin(), outer.blocks.end(), func[u].block) !=
+              outer.blocks.end())
+        return false;
+  }
+  return true;
+}
+
+bool LoopInterchange::reversesDependence(const std::vector<Access> &accesses,
+                                         const std::vector<LoopDimension> &dims,
+                                         const AliasAnalysis &aa) {
+  for (size_t x = 0; x < accesses.size(); x++)
+    for (size_t y = x; y < accesses.size(); y++) {
+      auto &a = accesses[x], &b = accesses[y];
+      if (!a.store && !b.store) continue;
+      if (!aa.may_alias(a.ptr, b.ptr)) continue;
+      if (a.base != b.base) return true;
+      auto distances = dependence_distances(a.index, b.index, dims);
+      if (!distances) return true;
+      for (auto d : *distances) {
+        // 按字典序取正方向，交换后 (<, >) 会变成负方向
+        if (d[0] < 0 || (d[0] == 0 && d[1] < 0)) {
+          d[0] = -d[0];
+          d[1] = -d[1];
+        }
+        if (d[0] > 0 && d[1] < 0) return true;
+      }
+    }
+  return false;
+}
+
+}  // namespace IR
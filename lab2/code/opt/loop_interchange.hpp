@@ -0,0 +1,58 @@
+#ifndef OPT_LOOP_INTERCHANGE_HPP
+#define OPT_LOOP_INTERCHANGE_HPP
+
+#include <string>
+#include <vector>
+
+#include "analysis/alias.hpp"
+#include "analysis/dependence.hpp"
+#include "analysis/induction.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Swaps the two loops of a perfect nest when the inner one walks
+/// memory with a larger stride than the outer one, e.g. a column-major
+/// walk over an `int a[N][M]`. Array accesses are flattened row-major
+/// with the strides of ArrayType::dims during lowering, so the stride of
+/// a loop is the coefficient of its variable in the subscripts.
+///
+/// The nest must be two counted loops whose bounds and starts do not
+/// depend on each other, with nothing but loop control outside the inner
+/// body and only sum reductions carried across iterations. The swap is
+/// done when no dependence between the accesses of the body has the
+/// direction (<, >), the only one interchange reverses.
+class LoopInterchange : public FunctionPass {
+ public:
+  const char *name() const override { return "interchange"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Function &func, AnalysisManager &am) override;
+
+ private:
+  int interchanged = 0;
+  std::vector<std::string> nests;
+
+  struct Access {
+    ValueId ptr;
+    ValueId base;
+    LinearIndex index;
+    bool store;
+  };
+
+  bool tryInterchange(Function &func, const LoopInfo &loops, const Loop &outer,
+                      const AliasAnalysis &aa);
+  /// @brief Whether the phis of both headers other than the induction
+  /// variables are sums carried from the outer loop through the inner one
+  static bool onlyReductions(const Function &func, const Loop &outer,
+                             const Loop &inner, ValueId outer_iv,
+                             ValueId inner_iv,
+                             const std::vector<std::vector<ValueId>> &users);
+  /// @brief Whether swapping would reverse some dependence
+  static bool reversesDependence(const std::vector<Access> &accesses,
+                                 const std::vector<LoopDimension> &dims,
+                                 const AliasAnalysis &aa);
+};
+
+}  // namespace IR
+
+#endif  // OPT_LOOP_INTERCHANGE_HPP
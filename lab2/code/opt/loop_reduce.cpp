@@ -0,0 +1,198 @@
+#include "loop_reduce.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace IR {
+
+std::string LoopStrengthReduce::stats() const {
+  return "reduced " + std::to_string(pointers) + " addresses and " +
+         std::to_string(multiplies) + " multiplications, replaced " +
+         std::to_string(exit_tests) + " exit tests";
+}
+
+PreservedAnalyses LoopStrengthReduce::run(Function &func, AnalysisManager &am) {
+  auto &loops = am.loops(func);
+  bool changed = false;
+  for (auto loop : loops.loops())
+    changed |= reduceLoop(func, loops, *loop);
+  if (!changed) return PreservedAnalyses::all();
+  return PreservedAnalyses::none()
+      .preserve(AnalysisKind::CFG)
+      .preserve(AnalysisKind::Dominators)
+      .preserve(AnalysisKind::Loops);
+}
+
+bool LoopStrengthReduce::reduceLoop(Function &func, const LoopInfo &loops,
+                                    const Loop &loop) {
+  InductionInfo ind(func, loops, loop);
+  if (ind.ivs().empty()) return false;
+  auto use_lists = users(func);
+  // 在循环外使用的值是最后一次迭代的结果，与新变量在循环头的值不同
+  auto used_inside = [&](ValueId v) {
+    return std::all_of(use_lists[v].begin(), use_lists[v].end(), [&](ValueId u) {
+      return loops.contains(&loop, func[u].block);
+    });
+  };
+  std::vector<Reduced> created;
+  bool changed = false;
+
+  std::vector<ValueId> candidates;
+  for (auto bb : loop.blocks)
+    for (auto id : func.blocks[bb].insts) candidates.push_back(id);
+  for (auto id : candidates) {
+    auto &inst = func[id];
+    if (inst.op != Opcode::Gep || !ind.invariant(inst.ops[0])) continue;
+    auto form = ind.affine(inst.ops[1]);
+    if (!form || form->scale == 0 || !used_inside(id)) continue;
+    // 下标就是基本归纳变量时没有可省的运算
+    if (func[inst.ops[1]].op == Opcode::Phi) continue;
+    func.replace_all_uses(id, reduced(func, loop, ind, created, *form, inst.ops[0]));
+    pointers++;
+    changed = true;
+  }
+  // 地址改写后只剩下仍被使用的乘法
+  if (changed) {
+    removeDead(func);
+    use_lists = users(func);
+  }
+  for (auto id : candidates) {
+    auto &inst = func[id];
+    if (inst.op != Opcode::Mul || inst.block == kNoBlock) continue;
+    auto form = ind.affine(id);
+    if (!form || form->scale == 0 || !used_inside(id)) continue;
+    func.replace_all_uses(id, reduced(func, loop, ind, created, *form, kNoValue));
+    multiplies++;
+    changed = true;
+  }
+  if (!changed) return false;
+  removeDead(func);
+
+  for (auto &r : created)
+    if (r.base == kNoValue && replaceExitTest(func, ind, r)) break;
+  return true;
+}
+
+ValueId LoopStrengthReduce::reduced(Function &func, const Loop &loop,
+                                    const InductionInfo &ind,
+                                    std::vector<Reduced> &created,
+                                    const AffineExpr &form, ValueId base) {
+  for (auto &r : created)
+    if (r.base == base && r.form.iv == form.iv && r.form.scale == form.scale &&
+        r.form.value == form.value && r.form.constant == form.constant)
+      return r.phi;
+  auto &iv = ind.ivs()[form.iv];
+  BlockId pre = loop.preheader, latch = loop.latches[0];
+
+  // 初值 scale * init + value + constant 在前置块中计算
+  ValueId start = emit(func, pre, Opcode::Mul, iv.init, func.const_int(form.scale));
+  if (form.value != kNoValue) start = emit(func, pre, Opcode::Add, start, form.value);
+  start = emit(func, pre, Opcode::Add, start, func.const_int(form.constant));
+  ValueId step = func.const_int((uint32_t)form.scale * (uint32_t)iv.step);
+
+  Type type = base == kNoValue ? Type::I32 : Type::Ptr;
+  ValueId phi = func.create(Opcode::Phi, type);
+  func.insert_after_phis(loop.header, phi);
+  ValueId next;
+  if (base == kNoValue) {
+    next = func.create(Opcode::Add, Type::I32, {phi, step});
+  } else {
+    auto addr = func.create(Opcode::Gep, Type::Ptr, {base, start});
+    func.insert_before_terminator(pre, addr);
+    start = addr;
+    next = func.create(Opcode::Gep, Type::Ptr, {phi, step});
+  }
+  func.insert_before_terminator(latch, next);
+  func.add_incoming(phi, start, pre);
+  func.add_incoming(phi, next, latch);
+  created.push_back(Reduced{form, base, phi});
+  return phi;
+}
+
+bool LoopStrengthReduce::replaceExitTest(Function &func,
+                                         const InductionInfo &ind,
+                                         const Reduced &r) {
+  auto test = ind.exit_test();
+  if (!test || test->iv != r.form.iv || r.form.value != kNoValue) return false;
+  auto &iv = ind.ivs()[test->iv];
+  if (!func.is_const(iv.init) || !func.is_const(test->bound)) return false;
+  ValueId cmp = test->cmp, term = func.terminator(func[cmp].block);
+
+  // 变量只用于自增和这次比较时才能替换
+  auto use_lists = users(func);
+  auto only = [&](ValueId v, std::vector<ValueId> allowed) {
+    return std::all_of(use_lists[v].begin(), use_lists[v].end(), [&](ValueId u) {
+      return std::find(allowed.begin(), allowed.end(), u) != allowed.end();
+    });
+  };
+  if (!only(iv.phi, {iv.next, cmp}) || !only(iv.next, {iv.phi}) ||
+      !only(cmp, {term}))
+    return false;
+
+  // 计数循环的变量的取值落在 [lo, hi] 内，映射到新变量时不能溢出
+  int64_t init = func[iv.init].imm, limit = func[test->bound].imm;
+  int64_t step = std::abs((int64_t)iv.step);
+  int64_t lo = std::min(init, limit) - step, hi = std::max(init, limit) + step;
+  auto map = [&](int64_t x) { return r.form.scale * x + r.form.constant; };
+  for (auto x : {lo, hi})
+    if (map(x) < INT32_MIN || map(x) > INT32_MAX) return false;
+
+  func[cmp].op = r.form.scale < 0 ? swap_compare(test->op) : test->op;
+  func.set_operand(cmp, 0, r.phi);
+  func.set_operand(cmp, 1, func.const_int(map(limit)));
+  std::vector<bool> dead(func.insts.size(), false);
+  dead[iv.phi] = dead[iv.next] = true;
+  func.remove_insts(dead);
+  exit_tests++;
+  return true;
+}
+
+ValueId LoopStrengthReduce::emit(Function &func, BlockId bb, Opcode op,
+                                 ValueId lhs, ValueId rhs) {
+  if (func.is_const(lhs) && func.is_const(rhs))
+    return func.const_int(*eval_binary(op, func[lhs].imm, func[rhs].imm));
+  if (func.is_const(rhs)) {
+    int c = func[rhs].imm;
+    if ((op == Opcode::Add && c == 0) || (op == Opcode::Mul && c == 1))
+      return lhs;
+  }
+  auto inst = func.create(op, Type::I32, {lhs, rhs});
+  func.insert_before_terminator(bb, inst);
+  return inst;
+}
+
+void LoopStrengthReduce::removeDead(Function &func) {
+  std::vector<int> uses(func.insts.size(), 0);
+  for (auto &block : func.blocks)
+    for (auto id : block.insts)
+      for (uint32_t i = 0; i < func[id].num_ops; i++) uses[func[id].ops[i]]++;
+  std::vector<ValueId> worklist;
+  for (auto &block : func.blocks)
+    for (auto id : block.insts)
+      if (!uses[id] && !func.has_side_effects(id)) worklist.push_back(id);
+  std::vector<bool> dead(func.insts.size(), false);
+  while (!worklist.empty()) {
+    ValueId id = worklist.back();
+    worklist.pop_back();
+    if (dead[id]) continue;
+    dead[id] = true;
+    for (uint32_t i = 0; i < func[id].num_ops; i++) {
+      ValueId op = func[id].ops[i];
+      if (--uses[op] == 0 && !is_floating(func[op].op) &&
+          !func.has_side_effects(op))
+        worklist.push_back(op);
+    }
+  }
+  func.remove_insts(dead);
+}
+
+std::vector<std::vector<ValueId>> LoopStrengthReduce::users(const Function &func) {
+  std::vector<std::vector<ValueId>> result(func.insts.size());
+  for (auto &block : func.blocks)
+    for (auto id : block.insts)
+      for (uint32_t i = 0; i < func[id].num_ops; i++)
+        result[func[id].ops[i]].push_back(id);
+  return result;
+}
+
+}  // namespace IR
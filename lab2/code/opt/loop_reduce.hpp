@@ -0,0 +1,58 @@
+#ifndef OPT_LOOP_REDUCE_HPP
+#define OPT_LOOP_REDUCE_HPP
+
+#include <vector>
+
+#include "analysis/induction.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Strength reduction of induction variables. An address
+/// `gep base, scale * i + offset` inside a loop becomes a pointer that
+/// starts at the first element in the preheader and advances by
+/// `scale * step` at the latch, and a multiplication of an induction
+/// variable becomes a new variable updated by addition. A basic variable
+/// that is then only compared against a constant to leave the loop is
+/// replaced in that test by one of the new variables, when the rewritten
+/// bound provably does not overflow.
+class LoopStrengthReduce : public FunctionPass {
+ public:
+  const char *name() const override { return "loop-reduce"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Function &func, AnalysisManager &am) override;
+
+ private:
+  int pointers = 0;
+  int multiplies = 0;
+  int exit_tests = 0;
+
+  /// @brief An induction variable created for a loop
+  struct Reduced {
+    AffineExpr form;
+    /// @brief The base address for pointers, kNoValue for integers
+    ValueId base;
+    ValueId phi;
+  };
+
+  bool reduceLoop(Function &func, const LoopInfo &loops, const Loop &loop);
+  /// @brief The phi computing `form` (or `base` + `form`), created on first
+  /// request
+  ValueId reduced(Function &func, const Loop &loop, const InductionInfo &ind,
+                  std::vector<Reduced> &created, const AffineExpr &form,
+                  ValueId base);
+  /// @brief Rewrite the exit test of the loop in terms of `r` if its
+  /// basic variable has no other use
+  bool replaceExitTest(Function &func, const InductionInfo &ind,
+                       const Reduced &r);
+  /// @brief Emit `lhs op rhs` at the end of `bb`, folding constants
+  static ValueId emit(Function &func, BlockId bb, Opcode op, ValueId lhs,
+                      ValueId rhs);
+  /// @brief Delete side-effect free instructions without uses
+  static void removeDead(Function &func);
+  static std::vector<std::vector<ValueId>> users(const Function &func);
+};
+
+}  // namespace IR
+
+#endif  // OPT_LOOP_REDUCE_HPP
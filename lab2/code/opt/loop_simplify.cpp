@@ -0,0 +1,61 @@
+#include "loop_simplify.hpp"
+
+#include <algorithm>
+
+namespace IR {
+
+std::string LoopSimplify::stats() const {
+  return "inserted " + std::to_string(inserted) + " preheaders";
+}
+
+PreservedAnalyses LoopSimplify::run(Function &func, AnalysisManager &am) {
+  auto &cfg = am.cfg(func);
+  auto &loops = am.loops(func);
+  // 先收集再修改，插入新块不会改变其他循环的进入边
+  std::vector<std::pair<BlockId, std::vector<BlockId>>> todo;
+  for (auto loop : loops.loops()) {
+    if (loop->preheader != kNoBlock) continue;
+    std::vector<BlockId> outside;
+    for (auto pred : cfg.preds[loop->header])
+      if (cfg.reachable(pred) && !loops.contains(loop, pred) &&
+          std::find(outside.begin(), outside.end(), pred) == outside.end())
+        outside.push_back(pred);
+    todo.emplace_back(loop->header, outside);
+  }
+  if (todo.empty()) return PreservedAnalyses::all();
+  for (auto &[header, outside] : todo) insertPreheader(func, header, outside);
+  inserted += todo.size();
+  return PreservedAnalyses::none();
+}
+
+void LoopSimplify::insertPreheader(Function &func, BlockId header,
+                                   const std::vector<BlockId> &outside) {
+  BlockId preheader = func.add_block();
+  for (auto pred : outside)
+    func.replace_target(func.terminator(pred), header, preheader);
+
+  // 循环头的 phi 中来自循环外的值先在前置块里汇合
+  for (auto phi : func.blocks[header].insts) {
+    if (func[phi].op != Opcode::Phi) break;
+    std::vector<std::pair<ValueId, BlockId>> moved;
+    for (uint32_t i = 0; i < func[phi].num_ops; i++) {
+      BlockId from = func[phi].targets[i];
+      if (std::find(outside.begin(), outside.end(), from) != outside.end())
+        moved.emplace_back(func[phi].ops[i], from);
+    }
+    for (auto pred : outside) func.remove_incoming(phi, pred);
+    ValueId value = moved.empty() ? func.undef(func[phi].type) : moved[0].first;
+    bool same = std::all_of(moved.begin(), moved.end(),
+                            [&](auto &in) { return in.first == value; });
+    if (!same) {
+      value = func.create(Opcode::Phi, func[phi].type);
+      func.append(preheader, value);
+      for (auto &[v, from] : moved) func.add_incoming(value, v, from);
+    }
+    func.add_incoming(phi, value, preheader);
+  }
+  auto br = func.create(Opcode::Br, Type::Void, {}, {header});
+  func.append(preheader, br);
+}
+
+}  // namespace IR
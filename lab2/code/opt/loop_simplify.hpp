@@ -0,0 +1,27 @@
+#ifndef OPT_LOOP_SIMPLIFY_HPP
+#define OPT_LOOP_SIMPLIFY_HPP
+
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Gives every loop a preheader, a block that enters the loop and
+/// does nothing else, so loop passes have a place to hoist code to.
+class LoopSimplify : public FunctionPass {
+ public:
+  const char *name() const override { return "loop-simplify"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Function &func, AnalysisManager &am) override;
+
+ private:
+  int inserted = 0;
+
+  /// @brief Route the edges from `outside` into `header` through a new
+  /// block
+  void insertPreheader(Function &func, BlockId header,
+                       const std::vector<BlockId> &outside);
+};
+
+}  // namespace IR
+
+#endif  // OPT_LOOP_SIMPLIFY_HPP
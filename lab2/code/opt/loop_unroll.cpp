@@ -0,0 +1,237 @@
+#include "loop_unroll.hpp"
+
+#include <algorithm>
+#include <memory>
+
+namespace IR {
+
+std::string LoopUnroll::stats() const {
+  std::string list;
+  for (auto &entry : unrolled) list += (list.empty() ? "" : ", ") + entry;
+  std::string result = "fully unrolled " + std::to_string(full) +
+                       " and partially unrolled " + std::to_string(partial) +
+                       " loops";
+  if (!list.empty()) result += " (" + list + ")";
+  return result;
+}
+
+PreservedAnalyses LoopUnroll::run(Function &func, AnalysisManager &am) {
+  auto &loops = am.loops(func);
+  // 展开会增加基本块，先在原来的控制流上分析完所有候选循环
+  std::vector<std::pair<const Loop *, std::unique_ptr<InductionInfo>>> candidates;
+  for (auto loop : loops.loops()) {
+    if (!loop->children.empty() || loop->preheader == kNoBlock ||
+        loop->latches.size() != 1)
+      continue;
+    auto ind = std::make_unique<InductionInfo>(func, loops, *loop);
+    if (ind->exit_test()) candidates.emplace_back(loop, std::move(ind));
+  }
+
+  bool changed = false;
+  for (auto &[loop, ind] : candidates) {
+    int size = 0;
+    for (auto bb : loop->blocks)
+      for (auto id : func.blocks[bb].insts)
+        if (func[id].op != Opcode::Phi && func[id].op != Opcode::Br) size++;
+    std::string where = func.name + ":bb" + std::to_string(loop->header);
+
+    auto trips = ind->trip_count();
+    if (trips && *trips > 0 && *trips <= kMaxFullTrips &&
+        *trips * size <= threshold) {
+      fullyUnroll(func, *loop, *trips);
+      unrolled.push_back(where + " x" + std::to_string(*trips) + " full");
+      full++;
+      changed = true;
+      continue;
+    }
+    int factor = 1;
+    while (factor * 2 <= kMaxFactor && factor * 2 * size <= threshold &&
+           (!trips || factor * 2 <= *trips))
+      factor *= 2;
+    if (factor < 2 || !partiallyUnroll(func, *loop, *ind, factor)) continue;
+    unrolled.push_back(where + " x" + std::to_string(factor));
+    partial++;
+    changed = true;
+  }
+  if (!changed) return PreservedAnalyses::all();
+  func.remove_unreachable_blocks();
+  return PreservedAnalyses::none();
+}
+
+std::vector<ValueId> LoopUnroll::headerPhis(const Function &func,
+                                            const Loop &loop) {
+  std::vector<ValueId> phis;
+  for (auto id : func.blocks[loop.header].insts) {
+    if (func[id].op != Opcode::Phi) break;
+    phis.push_back(id);
+  }
+  return phis;
+}
+
+LoopUnroll::Iteration LoopUnroll::cloneIteration(
+    Function &func, const Loop &loop, const std::vector<ValueId> &inputs) {
+  std::vector<BlockId> block_map(func.num_blocks(), kNoBlock);
+  for (auto bb : loop.blocks) block_map[bb] = func.add_block();
+  std::vector<ValueId> value_map(func.insts.size(), kNoValue);
+  auto phis = headerPhis(func, loop);
+  for (size_t k = 0; k < phis.size(); k++) value_map[phis[k]] = inputs[k];
+
+  // 与内联相同，先复制再统一改写操作数
+  std::vector<ValueId> copies;
+  ValueId header_term = func.terminator(loop.header);
+  for (auto bb : loop.blocks) {
+    auto insts = func.blocks[bb].insts;
+    for (auto id : insts) {
+      if (value_map[id] != kNoValue) continue;
+      ValueId copy;
+      if (id == header_term) {
+        // 这一轮的退出条件成立，直接进入循环体
+        copy = func.create(Opcode::Br, Type::Void, {},
+                           {block_map[func[id].targets[0]]});
+      } else {
+        auto &inst = func[id];
+        std::vector<ValueId> ops(inst.ops, inst.ops + inst.num_ops);
+        std::vector<BlockId> targets;
+        for (uint32_t i = 0; i < inst.num_targets; i++) {
+          BlockId t = inst.targets[i];
+          // 回边暂时仍指向原来的循环头，由调用者接到下一轮
+          bool back = t == loop.header && inst.op != Opcode::Phi;
+          targets.push_back(back ? t : block_map[t]);
+        }
+        copy = func.create(inst.op, inst.type, ops, targets, inst.imm);
+        func[copy].flags = func[id].flags;
+        auto name = func.names.find(id);
+        if (name != func.names.end())
+          func.names[copy] = name->second + "." + std::to_string(copy);
+        value_map[id] = copy;
+        copies.push_back(copy);
+      }
+      func.append(block_map[bb], copy);
+    }
+  }
+  auto map = [&](ValueId v) {
+    return v < value_map.size() && value_map[v] != kNoValue ? value_map[v] : v;
+  };
+  for (auto copy : copies)
+    for (uint32_t i = 0; i < func[copy].num_ops; i++)
+      func.set_operand(copy, i, map(func[copy].ops[i]));
+
+  Iteration it{block_map[loop.header], block_map[loop.latches[0]], {}};
+  for (auto phi : phis)
+    it.outputs.push_back(map(func.incoming(phi, loop.latches[0])));
+  return it;
+}
+
+void LoopUnroll::fullyUnroll(Function &func, const Loop &loop, int64_t trips) {
+  BlockId pre = loop.preheader, header = loop.header;
+  auto phis = headerPhis(func, loop);
+  std::vector<ValueId> values;
+  for (auto phi : phis) values.push_back(func.incoming(phi, pre));
+
+  BlockId from = pre;
+  for (int64_t k = 0; k < trips; k++) {
+    auto it = cloneIteration(func, loop, values);
+    func.replace_target(func.terminator(from), header, it.entry);
+    values = it.outputs;
+    from = it.latch;
+  }
+  // 最后一轮之后退出条件不成立，原来的循环头只剩下跳出循环
+  for (size_t k = 0; k < phis.size(); k++) {
+    func.remove_incoming(phis[k], pre);
+    func.add_incoming(phis[k], values[k], from);
+  }
+  ValueId term = func.terminator(header);
+  BlockId body = func[term].targets[0], exit = func[term].targets[1];
+  for (auto id : func.blocks[body].insts) {
+    if (func[id].op != Opcode::Phi) break;
+    func.remove_incoming(id, header);
+  }
+  func.detach(term);
+  func.append(header, func.create(Opcode::Br, Type::Void, {}, {exit}));
+}
+
+bool LoopUnroll::partiallyUnroll(Function &func, const Loop &loop,
+                                 const InductionInfo &ind, int factor) {
+  auto &test = *ind.exit_test();
+  auto &iv = ind.ivs()[test.iv];
+  BlockId pre = loop.preheader, header = loop.header;
+  // 剩余次数不少于 factor 等价于 iv 向前走 factor - 1 步后仍满足退出条件，
+  // 把这 factor - 1 步移到边界上：iv op bound - (factor - 1) * step
+  int64_t delta = (int64_t)(factor - 1) * iv.step;
+  bool guard = false;
+  ValueId limit;
+  if (func.is_const(test.bound)) {
+    int64_t value = func[test.bound].imm - delta;
+    if (value < INT32_MIN || value > INT32_MAX) return false;
+    limit = func.const_int(value);
+  } else {
+    limit = func.create(Opcode::Sub, Type::I32,
+                        {test.bound, func.const_int(delta)});
+    func.insert_before_terminator(pre, limit);
+    guard = true;
+  }
+
+  auto phis = headerPhis(func, loop);
+  std::vector<ValueId> inits;
+  for (auto phi : phis) inits.push_back(func.incoming(phi, pre));
+
+  // 展开后的循环：头部 uh 判断剩余次数，之后是 factor 份循环体
+  BlockId uh = func.add_block();
+  std::vector<ValueId> uh_phis;
+  for (size_t k = 0; k < phis.size(); k++) {
+    auto phi = func.create(Opcode::Phi, func[phis[k]].type);
+    func.append(uh, phi);
+    func.add_incoming(phi, inits[k], pre);
+    uh_phis.push_back(phi);
+  }
+  ValueId uh_iv = uh_phis[std::find(phis.begin(), phis.end(), iv.phi) - phis.begin()];
+  auto cmp = func.create(test.op, Type::I32, {uh_iv, limit});
+  func.append(uh, cmp);
+
+  std::vector<ValueId> values = uh_phis;
+  BlockId from = kNoBlock, first = kNoBlock;
+  for (int k = 0; k < factor; k++) {
+    auto it = cloneIteration(func, loop, values);
+    if (from == kNoBlock)
+      first = it.entry;
+    else
+      func.replace_target(func.terminator(from), header, it.entry);
+    values = it.outputs;
+    from = it.latch;
+  }
+  func.replace_target(func.terminator(from), header, uh);
+  for (size_t k = 0; k < phis.size(); k++)
+    func.add_incoming(uh_phis[k], values[k], from);
+
+  // 剩下的迭代交给原来的循环
+  BlockId rest = func.add_block();
+  func.append(uh, func.create(Opcode::CondBr, Type::Void, {cmp}, {first, rest}));
+  for (size_t k = 0; k < phis.size(); k++) {
+    ValueId value = uh_phis[k];
+    if (guard) {
+      value = func.create(Opcode::Phi, func[phis[k]].type);
+      func.append(rest, value);
+      func.add_incoming(value, inits[k], pre);
+      func.add_incoming(value, uh_phis[k], uh);
+    }
+    func.remove_incoming(phis[k], pre);
+    func.add_incoming(phis[k], value, rest);
+  }
+  func.append(rest, func.create(Opcode::Br, Type::Void, {}, {header}));
+
+  ValueId term = func.terminator(pre);
+  if (!guard) {
+    func.replace_target(term, header, uh);
+    return true;
+  }
+  // bound - delta 回绕时展开的循环一次也不能执行
+  int64_t edge = delta > 0 ? (int64_t)INT32_MIN + delta : (int64_t)INT32_MAX + delta;
+  auto ok = func.create(delta > 0 ? Opcode::Ge : Opcode::Le, Type::I32,
+                        {test.bound, func.const_int(edge)});
+  func.detach(term);
+  func.append(pre, ok);
+  func.append(pre, func.create(Opcode::CondBr, Type::Void, {ok}, {uh, rest}));
+  return true;
+}
+
+}  // namespace IR
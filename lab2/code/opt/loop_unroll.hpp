@@ -0,0 +1,58 @@
+#ifndef OPT_LOOP_UNROLL_HPP
+#define OPT_LOOP_UNROLL_HPP
+
+#include <string>
+#include <vector>
+
+#include "analysis/induction.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Unrolls innermost counted loops. A loop whose trip count is a
+/// small constant is replaced by that many copies of its body. Otherwise
+/// the body is copied `factor` times into a new loop that runs while at
+/// least `factor` iterations remain, and the original loop finishes the
+/// remaining ones. The threshold bounds the number of instructions an
+/// unrolled loop may have, so it also chooses the factor.
+class LoopUnroll : public FunctionPass {
+ public:
+  explicit LoopUnroll(int threshold = 64) : threshold(threshold) {}
+
+  const char *name() const override { return "unroll"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Function &func, AnalysisManager &am) override;
+
+ private:
+  int threshold;
+  static constexpr int kMaxFactor = 8;
+  static constexpr int kMaxFullTrips = 32;
+
+  int full = 0;
+  int partial = 0;
+  /// @brief One entry per unrolled loop, e.g. "main:bb3 x8"
+  std::vector<std::string> unrolled;
+
+  /// @brief A copy of one iteration of a loop
+  struct Iteration {
+    BlockId entry;
+    /// @brief The copy of the latch, still branching to the header
+    BlockId latch;
+    /// @brief The values of the header phis for the next iteration
+    std::vector<ValueId> outputs;
+  };
+
+  /// @brief Copy every block of `loop`, with the header phis replaced by
+  /// `inputs` and the exit test assumed to hold
+  static Iteration cloneIteration(Function &func, const Loop &loop,
+                                  const std::vector<ValueId> &inputs);
+  void fullyUnroll(Function &func, const Loop &loop, int64_t trips);
+  bool partiallyUnroll(Function &func, const Loop &loop,
+                       const InductionInfo &ind, int factor);
+  static std::vector<ValueId> headerPhis(const Function &func,
+                                         const Loop &loop);
+};
+
+}  // namespace IR
+
+#endif  // OPT_LOOP_UNROLL_HPP
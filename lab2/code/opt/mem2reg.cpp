@@ -0,0 +1,193 @@
+#include "mem2reg.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace IR {
+
+std::string Mem2Reg::stats() const {
+  return "promoted " + std::to_string(promoted) + " stack slots";
+}
+
+PreservedAnalyses Mem2Reg::run(Function &func, AnalysisManager &am) {
+  this->func = &func;
+  // 不可达的块没有支配关系，先删掉
+  if (func.remove_unreachable_blocks()) am.invalidate(func);
+  findSlots();
+  // 只改动块内的指令，控制流不变
+  auto preserved = PreservedAnalyses::none()
+                       .preserve(AnalysisKind::CFG)
+                       .preserve(AnalysisKind::Dominators)
+                       .preserve(AnalysisKind::Loops);
+  if (slots.empty()) return preserved;
+
+  auto &cfg = am.cfg(func);
+  auto &dom = am.dominators(func);
+  insertPhis(cfg, dom);
+  rename(cfg, dom);
+
+  // 把被删除的 load 的使用换成对应的值，并删掉栈槽和对它的读写
+  std::vector<bool> dead(func.insts.size(), false);
+  for (auto slot : slots) dead[slot] = true;
+  for (auto &block : func.blocks)
+    for (auto id : block.insts) {
+      auto &inst = func[id];
+      if ((inst.op == Opcode::Load && slot_index[inst.ops[0]] >= 0) ||
+          (inst.op == Opcode::Store && slot_index[inst.ops[1]] >= 0))
+        dead[id] = true;
+      for (uint32_t i = 0; i < inst.num_ops; i++)
+        inst.ops[i] = resolve(inst.ops[i]);
+    }
+  func.remove_insts(dead);
+  promoted += slots.size();
+  return preserved;
+}
+
+void Mem2Reg::findSlots() {
+  slots.clear();
+  slot_index.assign(func->insts.size(), -1);
+  for (auto id : func->blocks[0].insts) {
+    auto &inst = (*func)[id];
+    if (inst.op == Opcode::Alloca && inst.imm == 1) {
+      slot_index[id] = slots.size();
+      slots.push_back(id);
+    }
+  }
+  // 地址被当作值使用（传参、gep、存进内存）的栈槽不能提升
+  std::vector<bool> escaped(slots.size(), false);
+  for (auto &block : func->blocks)
+    for (auto id : block.insts) {
+      auto &inst = (*func)[id];
+      for (uint32_t i = 0; i < inst.num_ops; i++) {
+        int slot = slot_index[inst.ops[i]];
+        if (slot < 0) continue;
+        bool direct = (inst.op == Opcode::Load && i == 0) ||
+                      (inst.op == Opcode::Store && i == 1);
+        if (!direct) escaped[slot] = true;
+      }
+    }
+  std::vector<ValueId> kept;
+  for (size_t i = 0; i < slots.size(); i++) {
+    if (escaped[i]) {
+      slot_index[slots[i]] = -1;
+    } else {
+      slot_index[slots[i]] = kept.size();
+      kept.push_back(slots[i]);
+    }
+  }
+  slots.swap(kept);
+}
+
+void Mem2Reg::insertPhis(const CFG &cfg, const DominatorTree &dom) {
+  auto frontiers = dominance_frontiers(cfg, dom);
+  size_t num_blocks = func->num_blocks();
+  phi_slot.assign(func->insts.size(), -1);
+
+  // 每个栈槽的定义块，以及在块内先读后写（向上暴露）的块
+  std::vector<std::vector<BlockId>> defs(slots.size()), uses(slots.size());
+  std::vector<BlockId> seen_def(slots.size(), kNoBlock);
+  for (BlockId bb = 0; bb < num_blocks; bb++)
+    for (auto id : func->blocks[bb].insts) {
+      auto &inst = (*func)[id];
+      if (inst.op == Opcode::Load && slot_index[inst.ops[0]] >= 0) {
+        int slot = slot_index[inst.ops[0]];
+        if (seen_def[slot] != bb &&
+            (uses[slot].empty() || uses[slot].back() != bb))
+          uses[slot].push_back(bb);
+      } else if (inst.op == Opcode::Store && slot_index[inst.ops[1]] >= 0) {
+        int slot = slot_index[inst.ops[1]];
+        if (seen_def[slot] != bb) defs[slot].push_back(bb);
+        seen_def[slot] = bb;
+      }
+    }
+
+  // 以下数组按栈槽编号打标记，换一个栈槽时不需要清空
+  std::vector<int> def_mark(num_blocks, -1), live_mark(num_blocks, -1),
+      phi_mark(num_blocks, -1);
+  std::vector<BlockId> worklist;
+  for (int slot = 0; slot < (int)slots.size(); slot++) {
+    for (auto bb : defs[slot]) def_mark[bb] = slot;
+    // 活跃入口块：从向上暴露的使用出发逆着边传播，遇到定义块停止
+    worklist = uses[slot];
+    for (auto bb : worklist) live_mark[bb] = slot;
+    while (!worklist.empty()) {
+      BlockId bb = worklist.back();
+      worklist.pop_back();
+      for (auto pred : cfg.preds[bb])
+        if (live_mark[pred] != slot && def_mark[pred] != slot) {
+          live_mark[pred] = slot;
+          worklist.push_back(pred);
+        }
+    }
+
+    // 在迭代支配边界上放置 phi，只放在变量活跃的块
+    std::string name = func->names[slots[slot]];
+    worklist = defs[slot];
+    while (!worklist.empty()) {
+      BlockId bb = worklist.back();
+      worklist.pop_back();
+      for (auto join : frontiers[bb]) {
+        if (phi_mark[join] == slot || live_mark[join] != slot) continue;
+        phi_mark[join] = slot;
+        auto phi = func->create(Opcode::Phi, Type::I32);
+        func->insert_after_phis(join, phi);
+        func->names[phi] = name + "." + std::to_string(phi);
+        phi_slot.resize(func->insts.size(), -1);
+        phi_slot[phi] = slot;
+        if (def_mark[join] != slot) worklist.push_back(join);
+      }
+    }
+  }
+}
+
+void Mem2Reg::rename(const CFG &cfg, const DominatorTree &dom) {
+  ValueId undef = func->undef();
+  replacement.assign(func->insts.size(), kNoValue);
+  phi_slot.resize(func->insts.size(), -1);
+  slot_index.resize(func->insts.size(), -1);
+  std::vector<std::vector<ValueId>> stacks(slots.size());
+  auto current = [&](int slot) {
+    return stacks[slot].empty() ? undef : stacks[slot].back();
+  };
+
+  // 沿支配树先序遍历，离开一个块的子树时弹出它压入的值
+  std::vector<std::vector<int>> pushed(func->num_blocks());
+  std::vector<std::pair<BlockId, bool>> worklist{{0, false}};
+  while (!worklist.empty()) {
+    auto [bb, leaving] = worklist.back();
+    worklist.pop_back();
+    if (leaving) {
+      for (auto slot : pushed[bb]) stacks[slot].pop_back();
+      continue;
+    }
+    worklist.emplace_back(bb, true);
+
+    for (auto id : func->blocks[bb].insts) {
+      auto &inst = (*func)[id];
+      if (inst.op == Opcode::Phi && phi_slot[id] >= 0) {
+        stacks[phi_slot[id]].push_back(id);
+        pushed[bb].push_back(phi_slot[id]);
+      } else if (inst.op == Opcode::Load && slot_index[inst.ops[0]] >= 0) {
+        replacement[id] = current(slot_index[inst.ops[0]]);
+      } else if (inst.op == Opcode::Store && slot_index[inst.ops[1]] >= 0) {
+        int slot = slot_index[inst.ops[1]];
+        stacks[slot].push_back(resolve(inst.ops[0]));
+        pushed[bb].push_back(slot);
+      }
+    }
+    for (auto succ : cfg.succs[bb])
+      for (auto id : func->blocks[succ].insts) {
+        if ((*func)[id].op != Opcode::Phi) break;
+        if (phi_slot[id] >= 0) func->add_incoming(id, current(phi_slot[id]), bb);
+      }
+    for (auto child : dom.children(bb)) worklist.emplace_back(child, false);
+  }
+}
+
+ValueId Mem2Reg::resolve(ValueId value) const {
+  while (value < replacement.size() && replacement[value] != kNoValue)
+    value = replacement[value];
+  return value;
+}
+
+}  // namespace IR
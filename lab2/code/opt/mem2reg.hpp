@@ -0,0 +1,45 @@
+#ifndef OPT_MEM2REG_HPP
+#define OPT_MEM2REG_HPP
+
+#include <vector>
+
+#include "analysis/cfg.hpp"
+#include "analysis/dominators.hpp"
+#include "ir/ir.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Promotes scalar stack slots whose address never escapes into SSA
+/// values. Phis are placed on the iterated dominance frontier of the
+/// stores, pruned to the blocks where the variable is live, and named
+/// after the slot, i.e. after Symbol::unique_name.
+class Mem2Reg : public FunctionPass {
+ public:
+  const char *name() const override { return "mem2reg"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Function &func, AnalysisManager &am) override;
+
+ private:
+  /// @brief The number of promoted slots over all runs
+  int promoted = 0;
+  Function *func = nullptr;
+  /// @brief The promoted slots
+  std::vector<ValueId> slots;
+  /// @brief The index in `slots` of each value, -1 if not promoted
+  std::vector<int> slot_index;
+  /// @brief The slot of each inserted phi
+  std::vector<int> phi_slot;
+  /// @brief The value that replaces each deleted load
+  std::vector<ValueId> replacement;
+
+  /// @brief Collect the scalar slots that are only ever loaded and stored
+  void findSlots();
+  void insertPhis(const CFG &cfg, const DominatorTree &dom);
+  void rename(const CFG &cfg, const DominatorTree &dom);
+  ValueId resolve(ValueId value) const;
+};
+
+}  // namespace IR
+
+#endif  // OPT_MEM2REG_HPP
@@ -0,0 +1,130 @@
+#include "memoize.hpp"
+
+#include "analysis/call_graph.hpp"
+#include "analysis/purity.hpp"
+
+namespace IR {
+
+std::string Memoize::stats() const {
+  std::string list;
+  for (auto &name : memoized) list += (list.empty() ? "" : ", ") + name;
+  std::string res = "memoized " + std::to_string(memoized.size()) +
+                    " functions";
+  if (!list.empty()) res += " (" + list + ")";
+  return res;
+}
+
+PreservedAnalyses Memoize::run(Module &module, AnalysisManager &) {
+  CallGraph cg(module);
+  PurityAnalysis purity(module);
+  size_t n = module.functions.size();
+  // 先选出所有候选再改写：改写后的调用指向新加的包装函数，不在调用图中
+  std::vector<int> candidates;
+  for (size_t f = 0; f < n; f++) {
+    auto &func = *module.functions[f];
+    if (!purity.pure(f) || !cg.recursive(f) || func.ret_type != Type::I32 ||
+        func.args.empty() || func.args.size() > kMaxArgs)
+      continue;
+    // 只递归一次的函数每组参数本来就只算一次，缓存只会多一层调用
+    int recursive_calls = 0;
+    for (auto call : cg.call_sites[f])
+      if (cg.scc_of[func[call].imm] == cg.scc_of[f]) recursive_calls++;
+    if (recursive_calls >= 2) candidates.push_back(f);
+  }
+  for (auto f : candidates) {
+    auto &func = *module.functions[f];
+    std::string name = func.name;
+    func.name += ".impl";
+    int wrapper = module.add_function(wrap(module, f, name));
+    // 包括函数体中的递归调用在内，所有调用都先查表
+    for (auto &caller : module.functions) {
+      if (caller == module.functions[wrapper]) continue;
+      for (auto &block : caller->blocks)
+        for (auto id : block.insts)
+          if ((*caller)[id].op == Opcode::Call && (*caller)[id].imm == f)
+            (*caller)[id].imm = wrapper;
+    }
+    memoized.push_back(name);
+  }
+  if (module.functions.size() == n) return PreservedAnalyses::all();
+  return PreservedAnalyses::none();
+}
+
+FunctionPtr Memoize::wrap(Module &module, int impl, const std::string &name) {
+  auto &body = *module.functions[impl];
+  int num_args = body.args.size();
+  auto table = [&](const std::string &suffix, int64_t size) {
+    return module.add_global(Global{name + ".memo." + suffix, size, true,
+                                    false, InitImage::create(size)});
+  };
+  int keys = table("keys", (int64_t)kSlots * num_args);
+  int values = table("values", kSlots);
+  int valid = table("valid", kSlots);
+
+  auto func = Function::create(name, Type::I32, body.param_types);
+  auto &f = *func;
+  BlockId entry = f.add_block(), check = f.add_block(), hit = f.add_block(),
+          miss = f.add_block();
+  auto emit = [&](BlockId bb, Opcode op, Type type,
+                  const std::vector<ValueId> &ops) {
+    ValueId v = f.create(op, type, ops);
+    f.append(bb, v);
+    return v;
+  };
+  auto element = [&](BlockId bb, int global, ValueId index) {
+    return emit(bb, Opcode::Gep, Type::Ptr, {f.global_addr(global), index});
+  };
+
+  // 把参数合成一个数，再用乘法散列取高 kSlotBits 位作为槽号
+  ValueId key = f.args[0];
+  for (int i = 1; i < num_args; i++) {
+    key = emit(entry, Opcode::Mul, Type::I32, {key, f.const_int(31)});
+    key = emit(entry, Opcode::Add, Type::I32, {key, f.args[i]});
+  }
+  ValueId hash =
+      emit(entry, Opcode::Mul, Type::I32, {key, f.const_int(-1640531535)});
+  ValueId slot = emit(entry, Opcode::LShr, Type::I32,
+                      {hash, f.const_int(32 - kSlotBits)});
+  ValueId base = slot;
+  if (num_args > 1)
+    base = emit(entry, Opcode::Mul, Type::I32, {slot, f.const_int(num_args)});
+  ValueId filled =
+      emit(entry, Opcode::Load, Type::I32, {element(entry, valid, slot)});
+  f.append(entry,
+           f.create(Opcode::CondBr, Type::Void, {filled}, {check, miss}));
+
+  // 所有参数都与槽中的键相同才算命中
+  ValueId same = f.const_int(1);
+  for (int i = 0; i < num_args; i++) {
+    ValueId index = i ? emit(check, Opcode::Add, Type::I32,
+                             {base, f.const_int(i)})
+                      : base;
+    ValueId stored =
+        emit(check, Opcode::Load, Type::I32, {element(check, keys, index)});
+    ValueId eq = emit(check, Opcode::Eq, Type::I32, {stored, f.args[i]});
+    same = i ? emit(check, Opcode::Mul, Type::I32, {same, eq}) : eq;
+  }
+  f.append(check, f.create(Opcode::CondBr, Type::Void, {same}, {hit, miss}));
+
+  ValueId cached =
+      emit(hit, Opcode::Load, Type::I32, {element(hit, values, slot)});
+  f.append(hit, f.create(Opcode::Ret, Type::Void, {cached}));
+
+  // 未命中时计算并覆盖这个槽
+  ValueId result = emit(miss, Opcode::Call, Type::I32, f.args);
+  f[result].imm = impl;
+  for (int i = 0; i < num_args; i++) {
+    ValueId index = i ? emit(miss, Opcode::Add, Type::I32,
+                             {base, f.const_int(i)})
+                      : base;
+    emit(miss, Opcode::Store, Type::Void,
+         {f.args[i], element(miss, keys, index)});
+  }
+  emit(miss, Opcode::Store, Type::Void, {result, element(miss, values, slot)});
+  emit(miss, Opcode::Store, Type::Void,
+       {f.const_int(1), element(miss, valid, slot)});
+  f.append(miss, f.create(Opcode::Ret, Type::Void, {result}));
+  return func;
+}
+
+}  // namespace IR
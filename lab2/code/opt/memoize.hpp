@@ -0,0 +1,41 @@
+#ifndef OPT_MEMOIZE_HPP
+#define OPT_MEMOIZE_HPP
+
+#include <string>
+#include <vector>
+
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Caches the results of pure functions that recurse more than once
+/// per call, such as a naive `fib`. The body moves to a new function
+/// `<name>.impl`, and `<name>` becomes a wrapper that looks the arguments
+/// up in a direct-mapped table of kSlots entries in globals and only calls
+/// the body on a miss, storing the result. Recursive calls go through the
+/// wrapper as well, so every distinct argument list is computed about
+/// once. A colliding entry is simply overwritten, which keeps the memory
+/// bounded. Not part of any optimization level; enable it with e.g.
+/// `--passes=O2,memoize`. The pipeline moves it ahead of inline and ipcp,
+/// which would otherwise take the recursion apart first.
+class Memoize : public ModulePass {
+ public:
+  static constexpr int kSlotBits = 12;
+  static constexpr int kSlots = 1 << kSlotBits;
+  /// @brief Functions with more parameters are not worth a key compare
+  static constexpr int kMaxArgs = 3;
+
+  const char *name() const override { return "memoize"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Module &module, AnalysisManager &am) override;
+
+ private:
+  std::vector<std::string> memoized;
+
+  /// @brief Build the caching wrapper of function `impl` and return it
+  static FunctionPtr wrap(Module &module, int impl, const std::string &name);
+};
+
+}  // namespace IR
+
+#endif  // OPT_MEMOIZE_HPP
@@ -0,0 +1,41 @@
+#ifndef OPT_PASS_HPP
+#define OPT_PASS_HPP
+
+#include <memory>
+#include <string>
+
+#include "analysis/analysis_manager.hpp"
+#include "ir/ir.hpp"
+
+namespace IR {
+
+/// @brief A transformation run by the PassManager. Passes keep their own
+/// counters across runs and summarize them in stats().
+class Pass {
+ public:
+  virtual ~Pass() = default;
+  /// @brief The name used in pipelines and reports
+  virtual const char *name() const = 0;
+  /// @brief What the pass did, e.g. "promoted 3 stack slots"
+  virtual std::string stats() const { return ""; }
+};
+
+/// @brief A pass that transforms one function at a time
+class FunctionPass : public Pass {
+ public:
+  /// @return the analyses that are still valid for `func`
+  virtual PreservedAnalyses run(Function &func, AnalysisManager &am) = 0;
+};
+using FunctionPassPtr = std::shared_ptr<FunctionPass>;
+
+/// @brief A pass that sees the whole module, e.g. to inline calls
+class ModulePass : public Pass {
+ public:
+  /// @return the analyses that are still valid for every function
+  virtual PreservedAnalyses run(Module &module, AnalysisManager &am) = 0;
+};
+using ModulePassPtr = std::shared_ptr<ModulePass>;
+
+}  // namespace IR
+
+#endif  // OPT_PASS_HPP
@@ -0,0 +1,251 @@
+#include "pass_manager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include "ir/verifier.hpp"
+#include "opt/adce.hpp"
+#include "opt/div_const.hpp"
+#include "opt/dse.hpp"
+#include "opt/gvn.hpp"
+#include "opt/idiom.hpp"
+#include "opt/if_convert.hpp"
+#include "opt/inliner.hpp"
+#include "opt/ipcp.hpp"
+#include "opt/licm.hpp"
+#include "opt/load_elim.hpp"
+#include "opt/loop_interchange.hpp"
+#include "opt/loop_reduce.hpp"
+#include "opt/loop_simplify.hpp"
+#include "opt/loop_unroll.hpp"
+#include "opt/mem2reg.hpp"
+#include "opt/memoize.hpp"
+#include "opt/sccp.hpp"
+#include "opt/simplify_cfg.hpp"
+#include "opt/tail_recursion.hpp"
+
+namespace IR {
+
+/// @brief Adds a pass to a pipeline, `param` is the text after `=` in
+/// e.g. "inline=60", empty if none was given
+using PassFactory =
+    std::function<void(PassManager &, const std::string &param)>;
+
+/// @brief Every pass that can appear in a pipeline, by name
+static const std::map<std::string, PassFactory> &pass_registry() {
+  static const std::map<std::string, PassFactory> registry = {
+      {"mem2reg",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<Mem2Reg>());
+       }},
+      {"adce",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<ADCE>());
+       }},
+      {"gvn",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<GVN>());
+       }},
+      {"sccp",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<SCCP>());
+       }},
+      {"simplifycfg",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<SimplifyCFG>());
+       }},
+      {"loop-simplify",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<LoopSimplify>());
+       }},
+      {"loop-reduce",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<LoopStrengthReduce>());
+       }},
+      {"unroll",
+       [](PassManager &pm, const std::string &param) {
+         pm.add(param.empty() ? std::make_shared<LoopUnroll>()
+                              : std::make_shared<LoopUnroll>(std::stoi(param)));
+       }},
+      {"idiom",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<IdiomRecognize>());
+       }},
+      {"interchange",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<LoopInterchange>());
+       }},
+      {"licm",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<LICM>());
+       }},
+      {"load-elim",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<RedundantLoadElim>());
+       }},
+      {"dse",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<DeadStoreElim>());
+       }},
+      {"ifcvt",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<IfConversion>());
+       }},
+      {"div-const",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<DivByConst>());
+       }},
+      {"ipcp",
+       [](PassManager &pm, const std::string &param) {
+         pm.add(param.empty()
+                    ? std::make_shared<IPConstProp>()
+                    : std::make_shared<IPConstProp>(std::stoi(param)));
+       }},
+      {"memoize",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<Memoize>());
+       }},
+      {"tre",
+       [](PassManager &pm, const std::string &) {
+         pm.add(std::make_shared<TailRecursionElim>());
+       }},
+      {"inline",
+       [](PassManager &pm, const std::string &param) {
+         pm.add(param.empty() ? std::make_shared<Inliner>()
+                              : std::make_shared<Inliner>(std::stoi(param)));
+       }},
+  };
+  return registry;
+}
+
+/// @brief The named optimization levels
+static const std::map<std::string, std::vector<std::string>> &pipelines() {
+  static const std::map<std::string, std::vector<std::string>> levels = {
+      // 只做把栈槽提升为 SSA 值这一步，编译最快
+      {"O0", {"mem2reg"}},
+      // 内联和展开的阈值随优化级别提高，-O1 只处理很小的函数和循环
+      {"O1",
+       {"mem2reg", "tre", "inline=10", "sccp", "gvn", "load-elim", "dse",
+        "adce", "simplifycfg", "ifcvt", "loop-simplify", "licm", "unroll=16",
+        "div-const", "sccp", "simplifycfg"}},
+      {"O2",
+       {"mem2reg", "tre", "inline=60", "sccp", "ipcp", "sccp", "gvn",
+        "load-elim", "dse", "adce", "simplifycfg", "ifcvt", "loop-simplify",
+        "interchange", "licm", "unroll=96", "loop-simplify", "loop-reduce",
+        "div-const", "sccp", "gvn", "load-elim", "dse", "adce",
+        "simplifycfg"}},
+  };
+  return levels;
+}
+
+/// @brief Move the first `pass` in `names` in front of the earliest of
+/// the passes in `before`, if one comes ahead of it
+static void hoist(std::vector<std::string> &names, const std::string &pass,
+                  const std::vector<std::string> &before) {
+  auto it = std::find(names.begin(), names.end(), pass);
+  if (it == names.end()) return;
+  auto first = std::find_if(names.begin(), it, [&](const std::string &name) {
+    return std::find(before.begin(), before.end(),
+                     name.substr(0, name.find('='))) != before.end();
+  });
+  std::rotate(first, it, it + 1);
+}
+
+void PassManager::add(FunctionPassPtr pass) {
+  passes.push_back(Entry{pass, nullptr});
+}
+
+void PassManager::add(ModulePassPtr pass) {
+  passes.push_back(Entry{nullptr, pass});
+}
+
+PassManager PassManager::create(const std::string &pipeline) {
+  // 级别名展开成它的 pass 列表，可以与单独的 pass 混用，如 "O2,memoize"
+  std::vector<std::string> names;
+  std::stringstream ss(pipeline);
+  std::string name;
+  while (std::getline(ss, name, ',')) {
+    auto level = pipelines().find(name);
+    if (level != pipelines().end())
+      names.insert(names.end(), level->second.begin(), level->second.end());
+    else if (!name.empty())
+      names.push_back(name);
+  }
+  // memoize 要排在 inline 和 ipcp 之前，二者都会拆散它要缓存的递归，
+  // 例如 ipcp 会把 fib(24) 特化成一个不再递归的克隆；idiom 要在 unroll
+  // 复制循环体之前
+  hoist(names, "memoize", {"inline", "ipcp"});
+  hoist(names, "idiom", {"unroll"});
+  PassManager pm;
+  for (auto &name : names) {
+    auto eq = name.find('=');
+    std::string param = eq == std::string::npos ? "" : name.substr(eq + 1);
+    auto it = pass_registry().find(name.substr(0, eq));
+    if (it == pass_registry().end())
+      throw std::runtime_error("Unknown pass or pipeline: " + name);
+    it->second(pm, param);
+  }
+  return pm;
+}
+
+void PassManager::run(Module &module) {
+  for (auto &entry : passes) {
+    auto start = std::chrono::steady_clock::now();
+    if (entry.module_pass) {
+      am.invalidate_all(entry.module_pass->run(module, am));
+    } else {
+      for (auto &func : module.functions) {
+        if (func->is_external) continue;
+        am.invalidate(*func, entry.function_pass->run(*func, am));
+      }
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    entry.seconds += elapsed.count();
+    if (verify_each) verify(module, entry);
+  }
+}
+
+const Pass &PassManager::pass_of(const Entry &entry) const {
+  if (entry.module_pass) return *entry.module_pass;
+  return *entry.function_pass;
+}
+
+void PassManager::verify(const Module &module, const Entry &entry) const {
+  Verifier verifier;
+  if (!verifier.verify(module))
+    throw std::runtime_error("IR verification failed after " +
+                             std::string(pass_of(entry).name()) + ":\n" +
+                             verifier.message());
+}
+
+void PassManager::print_report(std::ostream &os) const {
+  auto ms = [](double seconds) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3) << seconds * 1000 << " ms";
+    return ss.str();
+  };
+  os << "Pass execution times:" << std::endl;
+  for (auto &entry : passes) {
+    auto &pass = pass_of(entry);
+    os << "  " << std::left << std::setw(16) << pass.name() << std::right
+       << std::setw(12) << ms(entry.seconds);
+    auto stats = pass.stats();
+    if (!stats.empty()) os << "  " << stats;
+    os << std::endl;
+  }
+  for (size_t i = 0; i < static_cast<size_t>(AnalysisKind::NumKinds); i++) {
+    auto kind = static_cast<AnalysisKind>(i);
+    if (!am.computed(kind)) continue;
+    os << "  " << std::left << std::setw(16) << analysis_to_string(kind)
+       << std::right << std::setw(12) << ms(am.seconds(kind)) << "  computed "
+       << am.computed(kind) << " times" << std::endl;
+  }
+}
+
+}  // namespace IR
@@ -0,0 +1,47 @@
+#ifndef OPT_PASS_MANAGER_HPP
+#define OPT_PASS_MANAGER_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "analysis/analysis_manager.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Runs a pipeline of function and module passes over a module,
+/// invalidating cached analyses as the passes report, and records the
+/// time spent in every pass.
+class PassManager {
+ public:
+  /// @brief Verify the module after every pass
+  bool verify_each = false;
+
+  void add(FunctionPassPtr pass);
+  void add(ModulePassPtr pass);
+
+  /// @brief Build a pipeline from a comma separated list of pass names and
+  /// level names ("O0", "O1", "O2")
+  static PassManager create(const std::string &pipeline);
+
+  void run(Module &module);
+  /// @brief Print the time and statistics of every pass
+  void print_report(std::ostream &os) const;
+
+ private:
+  struct Entry {
+    FunctionPassPtr function_pass;
+    ModulePassPtr module_pass;
+    double seconds = 0;
+  };
+  std::vector<Entry> passes;
+  AnalysisManager am;
+
+  const Pass &pass_of(const Entry &entry) const;
+  void verify(const Module &module, const Entry &entry) const;
+};
+
+}  // namespace IR
+
+#endif  // OPT_PASS_MANAGER_HPP
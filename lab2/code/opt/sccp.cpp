@@ -0,0 +1,184 @@
+#include "sccp.hpp"
+
+namespace IR {
+
+std::string SCCP::stats() const {
+  return "folded " + std::to_string(folded_values) + " values and " +
+         std::to_string(folded_branches) + " branches";
+}
+
+PreservedAnalyses SCCP::run(Function &func, AnalysisManager &) {
+  this->func = &func;
+  size_t n = func.insts.size();
+  values.assign(n, Lattice());
+  users.assign(n, {});
+  executable.assign(func.num_blocks(), false);
+  edges.clear();
+  for (auto &block : func.blocks)
+    for (auto id : block.insts) {
+      auto &inst = func[id];
+      for (uint32_t i = 0; i < inst.num_ops; i++)
+        users[inst.ops[i]].push_back(id);
+    }
+
+  executable[0] = true;
+  for (auto id : func.blocks[0].insts) visit(id);
+  while (!cfg_worklist.empty() || !ssa_worklist.empty()) {
+    while (!cfg_worklist.empty()) {
+      auto [from, to] = cfg_worklist.back();
+      cfg_worklist.pop_back();
+      if (!executable[to]) {
+        executable[to] = true;
+        for (auto id : func.blocks[to].insts) visit(id);
+      } else {
+        // 新的可执行边只影响目标块的 phi
+        for (auto id : func.blocks[to].insts) {
+          if (func[id].op != Opcode::Phi) break;
+          visit(id);
+        }
+      }
+    }
+    while (!ssa_worklist.empty()) {
+      ValueId v = ssa_worklist.back();
+      ssa_worklist.pop_back();
+      for (auto user : users[v])
+        if (executable[func[user].block]) visit(user);
+    }
+  }
+
+  if (!rewrite())
+    return PreservedAnalyses::none()
+        .preserve(AnalysisKind::CFG)
+        .preserve(AnalysisKind::Dominators)
+        .preserve(AnalysisKind::Loops);
+  return PreservedAnalyses::none();
+}
+
+SCCP::Lattice SCCP::get(ValueId v) const {
+  auto &inst = (*func)[v];
+  if (inst.op == Opcode::Const) return Lattice{Lattice::Const, inst.imm};
+  if (is_floating(inst.op)) return Lattice{Lattice::Bottom, 0};
+  return values[v];
+}
+
+void SCCP::update(ValueId v, Lattice lattice) {
+  auto &old = values[v];
+  if (old.state == lattice.state &&
+      (lattice.state != Lattice::Const || old.value == lattice.value))
+    return;
+  old = lattice;
+  ssa_worklist.push_back(v);
+}
+
+void SCCP::markEdge(BlockId from, BlockId to) {
+  if (edges.emplace(from, to).second) cfg_worklist.emplace_back(from, to);
+}
+
+SCCP::Lattice SCCP::evalPhi(ValueId id) const {
+  auto &inst = (*func)[id];
+  Lattice res;
+  for (uint32_t i = 0; i < inst.num_ops; i++) {
+    if (!edges.count({inst.targets[i], inst.block})) continue;
+    Lattice in = get(inst.ops[i]);
+    if (in.state == Lattice::Top) continue;
+    if (in.state == Lattice::Bottom ||
+        (res.state == Lattice::Const && res.value != in.value))
+      return Lattice{Lattice::Bottom, 0};
+    res = in;
+  }
+  return res;
+}
+
+SCCP::Lattice SCCP::evalSelect(ValueId id) const {
+  auto &inst = (*func)[id];
+  Lattice cond = get(inst.ops[0]);
+  if (cond.state == Lattice::Top) return cond;
+  if (cond.state == Lattice::Const) return get(inst.ops[cond.value ? 1 : 2]);
+  // 条件不确定时两个值必须相同
+  Lattice lhs = get(inst.ops[1]), rhs = get(inst.ops[2]);
+  if (lhs.state == Lattice::Top) return rhs;
+  if (rhs.state == Lattice::Top) return lhs;
+  if (lhs.state == Lattice::Const && rhs.state == Lattice::Const &&
+      lhs.value == rhs.value)
+    return lhs;
+  return Lattice{Lattice::Bottom, 0};
+}
+
+void SCCP::visit(ValueId id) {
+  auto &inst = (*func)[id];
+  BlockId bb = inst.block;
+  if (inst.op == Opcode::Phi) {
+    update(id, evalPhi(id));
+  } else if (is_binary(inst.op)) {
+    Lattice lhs = get(inst.ops[0]), rhs = get(inst.ops[1]);
+    if (lhs.state == Lattice::Top || rhs.state == Lattice::Top) return;
+    std::optional<int> res;
+    if (lhs.state == Lattice::Const && rhs.state == Lattice::Const)
+      res = eval_binary(inst.op, lhs.value, rhs.value);
+    update(id, res ? Lattice{Lattice::Const, *res} : Lattice{Lattice::Bottom, 0});
+  } else if (inst.op == Opcode::Select) {
+    update(id, evalSelect(id));
+  } else if (inst.op == Opcode::Br) {
+    markEdge(bb, inst.targets[0]);
+  } else if (inst.op == Opcode::CondBr) {
+    Lattice cond = get(inst.ops[0]);
+    if (cond.state == Lattice::Const) {
+      markEdge(bb, inst.targets[cond.value ? 0 : 1]);
+    } else if (cond.state == Lattice::Bottom) {
+      markEdge(bb, inst.targets[0]);
+      markEdge(bb, inst.targets[1]);
+    }
+  } else if (inst.type != Type::Void) {
+    // 读内存、调用、地址运算的结果都看作不确定
+    update(id, Lattice{Lattice::Bottom, 0});
+  }
+}
+
+bool SCCP::rewrite() {
+  auto &func = *this->func;
+  size_t n = func.insts.size();
+  std::vector<bool> dead(n, false);
+  std::vector<ValueId> replacement(n, kNoValue);
+  for (BlockId bb = 0; bb < func.num_blocks(); bb++) {
+    if (!executable[bb]) continue;
+    for (auto id : func.blocks[bb].insts) {
+      if (values[id].state != Lattice::Const) continue;
+      replacement[id] = func.const_int(values[id].value);
+      folded_values++;
+      if (!func.has_side_effects(id)) dead[id] = true;
+    }
+  }
+  for (auto &block : func.blocks)
+    for (auto id : block.insts) {
+      auto &inst = func[id];
+      for (uint32_t i = 0; i < inst.num_ops; i++)
+        if (inst.ops[i] < n && replacement[inst.ops[i]] != kNoValue)
+          inst.ops[i] = replacement[inst.ops[i]];
+    }
+  func.remove_insts(dead);
+
+  // 条件恒定的分支改成无条件跳转，另一条边上的 phi 来值随之删除
+  bool cfg_changed = false;
+  for (BlockId bb = 0; bb < func.num_blocks(); bb++) {
+    if (!executable[bb]) continue;
+    ValueId term = func.terminator(bb);
+    if (term == kNoValue || func[term].op != Opcode::CondBr) continue;
+    BlockId taken = func[term].targets[0], other = func[term].targets[1];
+    bool to_taken = edges.count({bb, taken}), to_other = edges.count({bb, other});
+    if (to_taken == to_other) continue;
+    if (!to_taken) std::swap(taken, other);
+    if (taken != other)
+      for (auto id : func.blocks[other].insts) {
+        if (func[id].op != Opcode::Phi) break;
+        func.remove_incoming(id, bb);
+      }
+    func.detach(term);
+    func.append(bb, func.create(Opcode::Br, Type::Void, {}, {taken}));
+    folded_branches++;
+    cfg_changed = true;
+  }
+  if (func.remove_unreachable_blocks()) cfg_changed = true;
+  return cfg_changed;
+}
+
+}  // namespace IR
@@ -0,0 +1,53 @@
+#ifndef OPT_SCCP_HPP
+#define OPT_SCCP_HPP
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Sparse conditional constant propagation (Wegman and Zadeck).
+/// Values and block reachability are solved together, so a value is only
+/// merged in from edges that can execute. Afterwards constant values are
+/// replaced, branches on constants become jumps and the blocks that can
+/// no longer execute are deleted. Arithmetic follows eval_binary, and a
+/// division by a constant zero is left to run.
+class SCCP : public FunctionPass {
+ public:
+  const char *name() const override { return "sccp"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Function &func, AnalysisManager &am) override;
+
+ private:
+  /// @brief Top: no value seen yet, Const: always `value`, Bottom: varies
+  struct Lattice {
+    enum State { Top, Const, Bottom } state = Top;
+    int value = 0;
+  };
+
+  Function *func = nullptr;
+  std::vector<Lattice> values;
+  std::vector<std::vector<ValueId>> users;
+  std::vector<bool> executable;
+  std::set<std::pair<BlockId, BlockId>> edges;
+  std::vector<std::pair<BlockId, BlockId>> cfg_worklist;
+  std::vector<ValueId> ssa_worklist;
+  int folded_values = 0;
+  int folded_branches = 0;
+
+  Lattice get(ValueId v) const;
+  void update(ValueId v, Lattice lattice);
+  void markEdge(BlockId from, BlockId to);
+  void visit(ValueId id);
+  Lattice evalPhi(ValueId id) const;
+  Lattice evalSelect(ValueId id) const;
+  /// @brief Rewrite the function with the solution
+  bool rewrite();
+};
+
+}  // namespace IR
+
+#endif  // OPT_SCCP_HPP
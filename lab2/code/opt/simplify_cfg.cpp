@@ -0,0 +1,208 @@
+#include "simplify_cfg.hpp"
+
+#include <algorithm>
+
+namespace IR {
+
+std::string SimplifyCFG::stats() const {
+  return "folded " + std::to_string(folded) + " branches, merged " +
+         std::to_string(merged) + " blocks, threaded " +
+         std::to_string(threaded) + " jumps, removed " +
+         std::to_string(removed) + " unreachable blocks";
+}
+
+PreservedAnalyses SimplifyCFG::run(Function &func, AnalysisManager &) {
+  this->func = &func;
+  bool changed_any = false;
+  while (true) {
+    int dropped = func.remove_unreachable_blocks();
+    removed += dropped;
+    bool changed = dropped > 0;
+
+    // 一轮中每个块至多改动一次，未改动的块在 cfg 中的信息仍然有效
+    CFG cfg(func);
+    touched.assign(func.num_blocks(), false);
+    num_uses.assign(func.insts.size(), 0);
+    for (auto &block : func.blocks)
+      for (auto id : block.insts) {
+        auto &inst = func[id];
+        for (uint32_t i = 0; i < inst.num_ops; i++) num_uses[inst.ops[i]]++;
+      }
+    for (auto bb : cfg.rpo) {
+      if (func.blocks[bb].removed || touched[bb]) continue;
+      if (foldBranch(bb) || mergeIntoPred(bb, cfg) || forwardJump(bb, cfg) ||
+          threadPhiBranch(bb, cfg))
+        changed = true;
+    }
+    if (!changed) break;
+    changed_any = true;
+  }
+  return changed_any ? PreservedAnalyses::none() : PreservedAnalyses::all();
+}
+
+bool SimplifyCFG::foldBranch(BlockId bb) {
+  ValueId term = func->terminator(bb);
+  if (term == kNoValue || (*func)[term].op != Opcode::CondBr) return false;
+  BlockId on_true = (*func)[term].targets[0], on_false = (*func)[term].targets[1];
+  ValueId cond = (*func)[term].ops[0];
+  if (anyTouched({on_true, on_false})) return false;
+
+  BlockId taken;
+  if (on_true == on_false) {
+    // 两条边去往同一个块，phi 从这两条边得到的值必须相同
+    for (auto id : func->blocks[on_true].insts) {
+      auto &phi = (*func)[id];
+      if (phi.op != Opcode::Phi) break;
+      ValueId value = func->incoming(id, bb);
+      for (uint32_t i = 0; i < phi.num_ops; i++)
+        if (phi.targets[i] == bb && phi.ops[i] != value) return false;
+    }
+    for (auto id : func->blocks[on_true].insts) {
+      if ((*func)[id].op != Opcode::Phi) break;
+      ValueId value = func->incoming(id, bb);
+      func->remove_incoming(id, bb);
+      func->add_incoming(id, value, bb);
+    }
+    taken = on_true;
+  } else if (func->is_const(cond)) {
+    taken = (*func)[cond].imm ? on_true : on_false;
+    BlockId other = taken == on_true ? on_false : on_true;
+    for (auto id : func->blocks[other].insts) {
+      if ((*func)[id].op != Opcode::Phi) break;
+      func->remove_incoming(id, bb);
+    }
+  } else {
+    return false;
+  }
+  func->detach(term);
+  func->append(bb, func->create(Opcode::Br, Type::Void, {}, {taken}));
+  touch({bb, on_true, on_false});
+  folded++;
+  return true;
+}
+
+bool SimplifyCFG::mergeIntoPred(BlockId bb, const CFG &cfg) {
+  if (bb == 0 || cfg.preds[bb].size() != 1) return false;
+  BlockId pred = cfg.preds[bb][0];
+  ValueId term = func->terminator(pred);
+  if (pred == bb || (*func)[term].op != Opcode::Br) return false;
+  if (touched[pred]) return false;
+  for (auto succ : cfg.succs[bb])
+    if (touched[succ]) return false;
+
+  // 只有一个前驱的块中的 phi 就是它唯一的来值
+  auto insts = func->blocks[bb].insts;
+  for (auto id : insts) {
+    if ((*func)[id].op != Opcode::Phi) break;
+    ValueId value = (*func)[id].ops[0];
+    func->replace_all_uses(id, value);
+    if ((*func)[value].block != kNoBlock) touch({(*func)[value].block});
+  }
+  func->detach(term);
+  for (auto id : insts) {
+    func->detach(id);
+    if ((*func)[id].op != Opcode::Phi) func->append(pred, id);
+  }
+  for (auto succ : cfg.succs[bb]) {
+    func->replace_incoming_block(succ, bb, pred);
+    touch({succ});
+  }
+  func->blocks[bb].removed = true;
+  touch({pred, bb});
+  merged++;
+  return true;
+}
+
+bool SimplifyCFG::forwardJump(BlockId bb, const CFG &cfg) {
+  auto &insts = func->blocks[bb].insts;
+  if (bb == 0 || insts.size() != 1 || (*func)[insts[0]].op != Opcode::Br)
+    return false;
+  BlockId dest = (*func)[insts[0]].targets[0];
+  if (dest == bb || anyTouched({dest})) return false;
+
+  bool any = false;
+  auto preds = cfg.preds[bb];
+  preds.erase(std::unique(preds.begin(), preds.end()), preds.end());
+  for (auto pred : preds) {
+    if (touched[pred] || !canRedirect(pred, bb, dest)) continue;
+    redirect(pred, bb, dest);
+    touch({pred});
+    any = true;
+  }
+  if (!any) return false;
+  touch({bb, dest});
+  threaded++;
+  return true;
+}
+
+bool SimplifyCFG::threadPhiBranch(BlockId bb, const CFG &cfg) {
+  auto &insts = func->blocks[bb].insts;
+  if (bb == 0 || insts.size() != 2) return false;
+  ValueId phi = insts[0], term = insts[1];
+  if ((*func)[phi].op != Opcode::Phi || (*func)[term].op != Opcode::CondBr ||
+      (*func)[term].ops[0] != phi || num_uses[phi] != 1)
+    return false;
+  BlockId on_true = (*func)[term].targets[0], on_false = (*func)[term].targets[1];
+  if (on_true == bb || on_false == bb || anyTouched({on_true, on_false}))
+    return false;
+
+  bool any = false;
+  auto preds = cfg.preds[bb];
+  std::sort(preds.begin(), preds.end());
+  for (size_t i = 0; i < preds.size(); i++) {
+    BlockId pred = preds[i];
+    // 有两条边进入本块的前驱不处理
+    if ((i > 0 && preds[i - 1] == pred) ||
+        (i + 1 < preds.size() && preds[i + 1] == pred))
+      continue;
+    ValueId value = func->incoming(phi, pred);
+    if (touched[pred] || !func->is_const(value)) continue;
+    BlockId dest = (*func)[value].imm ? on_true : on_false;
+    if (!canRedirect(pred, bb, dest)) continue;
+    redirect(pred, bb, dest);
+    touch({pred});
+    any = true;
+  }
+  if (!any) return false;
+  touch({bb, on_true, on_false});
+  threaded++;
+  return true;
+}
+
+bool SimplifyCFG::canRedirect(BlockId pred, BlockId via, BlockId dest) const {
+  auto succs = func->succs(pred);
+  if (std::find(succs.begin(), succs.end(), dest) == succs.end()) return true;
+  for (auto id : func->blocks[dest].insts) {
+    if ((*func)[id].op != Opcode::Phi) break;
+    if (func->incoming(id, pred) != func->incoming(id, via)) return false;
+  }
+  return true;
+}
+
+void SimplifyCFG::redirect(BlockId pred, BlockId via, BlockId dest) {
+  ValueId term = func->terminator(pred);
+  auto succs = func->succs(pred);
+  auto edges = std::count(succs.begin(), succs.end(), via);
+  for (auto id : func->blocks[dest].insts) {
+    if ((*func)[id].op != Opcode::Phi) break;
+    ValueId value = func->incoming(id, via);
+    for (long i = 0; i < edges; i++) func->add_incoming(id, value, pred);
+  }
+  for (auto id : func->blocks[via].insts) {
+    if ((*func)[id].op != Opcode::Phi) break;
+    func->remove_incoming(id, pred);
+  }
+  func->replace_target(term, via, dest);
+}
+
+bool SimplifyCFG::anyTouched(std::initializer_list<BlockId> blocks) const {
+  for (auto bb : blocks)
+    if (touched[bb]) return true;
+  return false;
+}
+
+void SimplifyCFG::touch(std::initializer_list<BlockId> blocks) {
+  for (auto bb : blocks) touched[bb] = true;
+}
+
+}  // namespace IR
@@ -0,0 +1,49 @@
+#ifndef OPT_SIMPLIFY_CFG_HPP
+#define OPT_SIMPLIFY_CFG_HPP
+
+#include <vector>
+
+#include "analysis/cfg.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Cleans up the control flow graph until nothing changes:
+/// - branches on constants or to a single block become jumps
+/// - unreachable blocks are deleted
+/// - a block is merged into its only predecessor if that jumps only to it
+/// - jumps to a block that only jumps on are threaded to the final target
+/// - predecessors that pass a constant to a block that only branches on
+///   that phi are threaded straight to the known successor, which undoes
+///   the join blocks left by `&&` and `||`
+class SimplifyCFG : public FunctionPass {
+ public:
+  const char *name() const override { return "simplifycfg"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Function &func, AnalysisManager &am) override;
+
+ private:
+  Function *func = nullptr;
+  /// @brief Blocks changed in the current sweep; their entries in the CFG
+  /// of the sweep are stale
+  std::vector<bool> touched;
+  std::vector<uint32_t> num_uses;
+  int folded = 0, merged = 0, threaded = 0, removed = 0;
+
+  bool foldBranch(BlockId bb);
+  bool mergeIntoPred(BlockId bb, const CFG &cfg);
+  bool forwardJump(BlockId bb, const CFG &cfg);
+  bool threadPhiBranch(BlockId bb, const CFG &cfg);
+  /// @brief Whether the phis of `dest` can take the values they receive
+  /// from `via` from `pred` as well, which is the case unless `pred`
+  /// already reaches `dest` with different values
+  bool canRedirect(BlockId pred, BlockId via, BlockId dest) const;
+  /// @brief Redirect the edges `pred` -> `via` to `dest`
+  void redirect(BlockId pred, BlockId via, BlockId dest);
+  bool anyTouched(std::initializer_list<BlockId> blocks) const;
+  void touch(std::initializer_list<BlockId> blocks);
+};
+
+}  // namespace IR
+
+#endif  // OPT_SIMPLIFY_CFG_HPP
@@ -0,0 +1,124 @@
+#include "tail_recursion.hpp"
+
+#include <algorithm>
+
+namespace IR {
+
+std::string TailRecursionElim::stats() const {
+  int total = 0;
+  std::string detail;
+  for (auto &[func, n] : eliminated) {
+    total += n;
+    detail += (detail.empty() ? "" : ", ") + func + " x" + std::to_string(n);
+  }
+  std::string res = "eliminated " + std::to_string(total) + " self calls";
+  if (!detail.empty()) res += " (" + detail + ")";
+  return res + ", marked " + std::to_string(marked) + " tail calls";
+}
+
+PreservedAnalyses TailRecursionElim::run(Module &module,
+                                         AnalysisManager &am) {
+  bool changed = false;
+  for (size_t index = 0; index < module.functions.size(); index++) {
+    auto &func = *module.functions[index];
+    if (func.is_external) continue;
+    std::vector<ValueId> self, others;
+    {
+      AliasAnalysis aa(func);
+      for (auto &block : func.blocks)
+        for (auto id : block.insts) {
+          auto &inst = func[id];
+          if (inst.op != Opcode::Call) continue;
+          // 先清掉旧的标记，之前的变换可能已经改变了调用的位置
+          inst.flags &= ~kCallTail;
+          if (!inTailPosition(func, id) || passesFrame(func, aa, id)) continue;
+          if (inst.imm == (int)index)
+            self.push_back(id);
+          else
+            others.push_back(id);
+        }
+    }
+    for (auto id : others) func[id].flags |= kCallTail;
+    marked += others.size();
+    if (self.empty()) continue;
+    eliminate(func, self);
+    eliminated[func.name] += self.size();
+    am.invalidate(func, PreservedAnalyses::none());
+    changed = true;
+  }
+  return changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+}
+
+bool TailRecursionElim::inTailPosition(const Function &func, ValueId call) {
+  auto &insts = func.blocks[func[call].block].insts;
+  auto it = std::find(insts.begin(), insts.end(), call);
+  auto &next = func[*(it + 1)];
+  if (next.op == Opcode::Ret)
+    return next.num_ops == 0 || next.ops[0] == call;
+  if (next.op != Opcode::Br) return false;
+  // 跳到只做返回的块，返回值可以经过一个 phi
+  BlockId bb = func[call].block, dest = next.targets[0];
+  ValueId ret = func.terminator(dest);
+  if (ret == kNoValue || func[ret].op != Opcode::Ret) return false;
+  for (auto id : func.blocks[dest].insts)
+    if (id != ret && func[id].op != Opcode::Phi) return false;
+  if (func[ret].num_ops == 0) return true;
+  ValueId value = func[ret].ops[0];
+  if (value == call) return true;
+  return func[value].op == Opcode::Phi && func[value].block == dest &&
+         func.incoming(value, bb) == call;
+}
+
+bool TailRecursionElim::passesFrame(const Function &func,
+                                    const AliasAnalysis &aa, ValueId call) {
+  auto &inst = func[call];
+  for (uint32_t i = 0; i < inst.num_ops; i++) {
+    if (func[inst.ops[i]].type != Type::Ptr) continue;
+    ValueId obj = aa.object(inst.ops[i]);
+    if (obj == kNoValue || func[obj].op == Opcode::Alloca) return true;
+  }
+  return false;
+}
+
+void TailRecursionElim::eliminate(Function &func,
+                                  const std::vector<ValueId> &calls) {
+  // 入口块只留下栈槽，其余部分成为循环头，栈槽在各次迭代间复用
+  BlockId header = func.add_block();
+  auto &entry = func.blocks[0].insts;
+  auto first = std::find_if(entry.begin(), entry.end(), [&](ValueId id) {
+    return func[id].op != Opcode::Alloca;
+  });
+  std::vector<ValueId> moved(first, entry.end());
+  entry.erase(first, entry.end());
+  for (auto id : moved) func.append(header, id);
+  for (auto succ : func.succs(header))
+    func.replace_incoming_block(succ, 0, header);
+  func.append(0, func.create(Opcode::Br, Type::Void, {}, {header}));
+
+  // 形参换成 phi，第一次迭代取实参，之后取尾调用传入的值
+  std::vector<ValueId> params;
+  for (auto arg : func.args) {
+    ValueId phi = func.create(Opcode::Phi, func[arg].type);
+    func.replace_all_uses(arg, phi);
+    func.insert_after_phis(header, phi);
+    func.add_incoming(phi, arg, 0);
+    params.push_back(phi);
+  }
+  for (auto call : calls) {
+    BlockId bb = func[call].block;
+    for (size_t i = 0; i < params.size(); i++)
+      func.add_incoming(params[i], func[call].ops[i], bb);
+    ValueId next = func.terminator(bb);
+    if (func[next].op == Opcode::Br) {
+      for (auto id : func.blocks[func[next].targets[0]].insts) {
+        if (func[id].op != Opcode::Phi) break;
+        func.remove_incoming(id, bb);
+      }
+    }
+    func.detach(next);
+    func.detach(call);
+    func.append(bb, func.create(Opcode::Br, Type::Void, {}, {header}));
+  }
+}
+
+}  // namespace IR
@@ -0,0 +1,44 @@
+#ifndef OPT_TAIL_RECURSION_HPP
+#define OPT_TAIL_RECURSION_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "analysis/alias.hpp"
+#include "opt/pass.hpp"
+
+namespace IR {
+
+/// @brief Tail-recursion elimination. A call of a function to itself whose
+/// result is returned right away, as in `return gcd(b, a % b);`, becomes a
+/// jump back to the start of the function with the arguments passed
+/// through phis, so the recursion runs as a loop in one stack frame. The
+/// remaining calls in tail position are marked with kCallTail when their
+/// arguments do not point into the caller's frame, which lets a backend
+/// emit them as jumps.
+class TailRecursionElim : public ModulePass {
+ public:
+  const char *name() const override { return "tre"; }
+  std::string stats() const override;
+  PreservedAnalyses run(Module &module, AnalysisManager &am) override;
+
+ private:
+  /// @brief The number of self calls turned into jumps in each function
+  std::map<std::string, int> eliminated;
+  int marked = 0;
+
+  /// @brief Whether `call` is followed by returning its result, directly or
+  /// through a block that only returns
+  static bool inTailPosition(const Function &func, ValueId call);
+  /// @brief Whether an argument of `call` may point into the caller's stack
+  /// slots
+  static bool passesFrame(const Function &func, const AliasAnalysis &aa,
+                          ValueId call);
+  /// @brief Turn the self calls `calls` into jumps to a new loop header
+  static void eliminate(Function &func, const std::vector<ValueId> &calls);
+};
+
+}  // namespace IR
+
+#endif  // OPT_TAIL_RECURSION_HPP
@@ -10,8 +10,6 @@ extern int yylex(void);
 using namespace AST;
 extern NodePtr root;
 
-#define INT_MAX 99
-
 template <typename T>
 inline std::shared_ptr<T> shared_cast(Node *ptr) {
   return std::shared_ptr<T>(static_cast<T *>(ptr));
@@ -60,6 +58,7 @@ inline std::shared_ptr<T> shared_cast(Node *ptr) {
 %token LBRACE "{"
 %token RBRACE "}"
 %token INT "int"
+%token CONST "const"
 %token RETURN "return"
 %token VOID "void"
 %token IF "if"
@@ -96,6 +95,8 @@ CompUnit : FuncDef { $$ = new CompUnit(shared_cast<FuncDef>($1)); }
 
 Decl : VarDecl { $$ = $1; }
 		| ArrDecl { $$ = $1; }
+		| "const" VarDecl { static_cast<VarDecl*>($2)->is_const = true; $$ = $2; }
+		| "const" ArrDecl { static_cast<ArrDecl*>($2)->is_const = true; $$ = $2; }
     ;
 
 // 由于 union 中的类型不能是 std::shared_ptr
@@ -138,17 +139,18 @@ ArrDef : IDENT ArrLists {
 
 ArrLists : ArrList { 
 			auto ast = new ArrLists();
-			ast->add_list(shared_cast<IntConst>($1));
+			ast->add_list(NodePtr($1));
 			$$ = ast;
 		}
 		| ArrLists ArrList {
 			auto ast = new ArrLists(shared_cast<ArrLists>($1));
-			ast->add_list(shared_cast<IntConst>($2));
+			ast->add_list(NodePtr($2));
 			$$ = ast;
 		}
 		;
 
-ArrList : "[" INTCONST "]" { $$ = new IntConst($2); }
+// 数组的维度可以是常量表达式，由类型检查求值
+ArrList : "[" Exp "]" { $$ = $2; }
 		;
 
 // InitVal : Exp { auto ast = new InitVal(); ast->add_arg(shared_cast<Node>($1)); $$ = ast; }
@@ -211,15 +213,12 @@ FuncFParams : FuncFParam {
 		;
 
 FuncFParam : "int" IDENT { $$ = new FuncFParam(BasicType::Int, $2, false); }
+		// 数组参数的第一维未知，args 中只保存后面的维度
 		| "int" IDENT "[" "]" {
-			auto ast = std::make_shared<ArrLists>();
-			ast->add_list(std::make_shared<IntConst>(INT_MAX));
-			$$ = new FuncFParam(BasicType::Int, $2, true, ast); 
+			$$ = new FuncFParam(BasicType::Int, $2, true, std::make_shared<ArrLists>()); 
 			}
 		| "int" IDENT "[" "]" ArrLists {
-			auto ast = std::make_shared<ArrLists>(shared_cast<ArrLists>($5));
-			ast->add_list(std::make_shared<IntConst>(INT_MAX));
-			$$ = new FuncFParam(BasicType::Int, $2, true, ast); 
+			$$ = new FuncFParam(BasicType::Int, $2, true, shared_cast<ArrLists>($5)); 
 		}
 
 
@@ -0,0 +1,87 @@
+#include "const_eval.hpp"
+
+#include <climits>
+#include <cstdint>
+
+std::optional<int> eval_binary_op(BinaryOp op, int lhs, int rhs) {
+  // 用无符号数运算来得到补码回绕的结果
+  uint32_t a = lhs, b = rhs;
+  switch (op) {
+    case BinaryOp::Add: return (int)(a + b);
+    case BinaryOp::Sub: return (int)(a - b);
+    case BinaryOp::Mul: return (int)(a * b);
+    case BinaryOp::Div:
+      if (rhs == 0) return std::nullopt;
+      if (lhs == INT_MIN && rhs == -1) return INT_MIN;
+      return lhs / rhs;
+    case BinaryOp::Mod:
+      if (rhs == 0) return std::nullopt;
+      if (lhs == INT_MIN && rhs == -1) return 0;
+      return lhs % rhs;
+    case BinaryOp::Les: return lhs < rhs;
+    case BinaryOp::Leq: return lhs <= rhs;
+    case BinaryOp::Gre: return lhs > rhs;
+    case BinaryOp::Geq: return lhs >= rhs;
+    case BinaryOp::Eql: return lhs == rhs;
+    case BinaryOp::Neq: return lhs != rhs;
+    case BinaryOp::And: return lhs && rhs;
+    case BinaryOp::Or: return lhs || rhs;
+    case BinaryOp::Not: break;
+  }
+  return std::nullopt;
+}
+
+std::optional<int> eval_unary_op(BinaryOp op, int val) {
+  switch (op) {
+    case BinaryOp::Add: return val;
+    case BinaryOp::Sub: return (int)(0u - (uint32_t)val);
+    case BinaryOp::Not: return !val;
+    default: break;
+  }
+  return std::nullopt;
+}
+
+std::optional<int> ConstEvaluator::eval(AST::NodePtr node) {
+  if (auto n = std::dynamic_pointer_cast<AST::IntConst>(node)) return n->value;
+  if (auto n = std::dynamic_pointer_cast<AST::LVal>(node)) return evalLVal(n);
+  if (auto n = std::dynamic_pointer_cast<AST::UnaryExp>(node)) {
+    auto val = eval(n->exp);
+    if (!val) return std::nullopt;
+    return eval_unary_op(n->op, *val);
+  }
+  if (auto n = std::dynamic_pointer_cast<AST::BinaryExp>(node)) {
+    auto lhs = eval(n->left);
+    if (!lhs) return std::nullopt;
+    // && 和 || 的短路求值：右侧不必是常量
+    if (n->op == BinaryOp::And && !*lhs) return 0;
+    if (n->op == BinaryOp::Or && *lhs) return 1;
+    auto rhs = eval(n->right);
+    if (!rhs) return std::nullopt;
+    return eval_binary_op(n->op, *lhs, *rhs);
+  }
+  // InitVal 只会出现在标量的初始化中
+  if (auto n = std::dynamic_pointer_cast<AST::InitVal>(node))
+    if (n->args.size() == 1) return eval(n->args[0]);
+  return std::nullopt;
+}
+
+std::optional<int> ConstEvaluator::evalLVal(AST::LValPtr node) {
+  auto symbol = node->symbol;
+  if (!symbol || !symbol->is_const) return std::nullopt;
+  if (!node->is_arr) {
+    if (symbol->layout) return std::nullopt;
+    return symbol->const_value;
+  }
+  // 常量数组只有在所有下标都是常量时才能求值
+  auto index = std::dynamic_pointer_cast<AST::ExpList>(node->index);
+  auto &layout = symbol->layout;
+  if (!layout || index->args.size() != layout->rank()) return std::nullopt;
+  int64_t offset = 0;
+  for (size_t k = 0; k < index->args.size(); k++) {
+    auto idx = eval(index->args[k]);
+    // 越界的下标不是常量表达式，留给需要常量的地方报错，其余照常读取
+    if (!idx || *idx < 0 || *idx >= layout->dims[k]) return std::nullopt;
+    offset += *idx * layout->strides[k];
+  }
+  return symbol->const_image->const_at(offset);
+}
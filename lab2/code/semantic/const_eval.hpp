@@ -0,0 +1,32 @@
+#ifndef SEMANTIC_CONST_EVAL_HPP
+#define SEMANTIC_CONST_EVAL_HPP
+
+#include <optional>
+
+#include "ast/tree.hpp"
+#include "common.hpp"
+
+/// @brief Evaluate `lhs op rhs` with the 32-bit semantics of the target:
+/// `+ - *` wrap around, `/` and `%` truncate toward zero and
+/// `INT_MIN / -1` wraps to INT_MIN (with remainder 0)
+/// @return std::nullopt for division or modulo by zero
+std::optional<int> eval_binary_op(BinaryOp op, int lhs, int rhs);
+
+/// @brief Evaluate the unary `op val`, `-INT_MIN` wraps to INT_MIN
+std::optional<int> eval_unary_op(BinaryOp op, int val);
+
+/// @brief Evaluates constant expressions on a type-checked AST.
+/// Literals, reads of `const` scalars, reads of `const` array elements with
+/// constant in-range subscripts and operators over them are constant.
+class ConstEvaluator {
+ public:
+  /// @brief Evaluate `node`
+  /// @return The value if `node` is a constant expression, std::nullopt
+  /// otherwise
+  std::optional<int> eval(AST::NodePtr node);
+
+ private:
+  std::optional<int> evalLVal(AST::LValPtr node);
+};
+
+#endif  // SEMANTIC_CONST_EVAL_HPP
@@ -0,0 +1,171 @@
+#include "const_folder.hpp"
+
+static std::optional<int> const_of(AST::NodePtr node) {
+  if (auto n = std::dynamic_pointer_cast<AST::IntConst>(node)) return n->value;
+  return std::nullopt;
+}
+
+int ConstFolder::run(AST::NodePtr root) {
+  int before = count_nodes(root);
+  fold(root);
+  return before - count_nodes(root);
+}
+
+int ConstFolder::count_nodes(AST::NodePtr node) {
+  if (!node) return 0;
+  int cnt = 1;
+  for (auto child : node->get_children()) cnt += count_nodes(child);
+  return cnt;
+}
+
+bool ConstFolder::is_pure(AST::NodePtr node) {
+  if (!node || type_of<AST::FuncCall>(node)) return !node;
+  for (auto child : node->get_children())
+    if (!is_pure(child)) return false;
+  return true;
+}
+
+AST::NodePtr ConstFolder::make_const(int value, AST::NodePtr from) {
+  auto node = std::make_shared<AST::IntConst>(value);
+  node->lineno = from->lineno;
+  return node;
+}
+
+AST::NodePtr ConstFolder::fold(AST::NodePtr node) {
+  if (!node) return node;
+  if (auto n = std::dynamic_pointer_cast<AST::BinaryExp>(node))
+    return foldBinaryExp(n);
+  if (auto n = std::dynamic_pointer_cast<AST::UnaryExp>(node))
+    return foldUnaryExp(n);
+  if (auto n = std::dynamic_pointer_cast<AST::LVal>(node)) {
+    if (n->is_arr) fold(n->index);
+  } else if (auto n = std::dynamic_pointer_cast<AST::ExpList>(node)) {
+    for (auto &arg : n->args) arg = fold(arg);
+  } else if (auto n = std::dynamic_pointer_cast<AST::FuncCall>(node)) {
+    for (auto &arg : n->args) arg = fold(arg);
+  } else if (auto n = std::dynamic_pointer_cast<AST::CompUnit>(node)) {
+    for (auto &unit : n->units) fold(unit);
+  } else if (auto n = std::dynamic_pointer_cast<AST::FuncDef>(node)) {
+    fold(n->block);
+  } else if (auto n = std::dynamic_pointer_cast<AST::Block>(node)) {
+    for (auto &stmt : n->stmts) stmt = fold(stmt);
+  } else if (auto n = std::dynamic_pointer_cast<AST::VarDecl>(node)) {
+    for (auto &def : n->defs)
+      if (def->val.has_value())
+        foldInitVal(std::dynamic_pointer_cast<AST::InitVal>(def->val.value()));
+  } else if (auto n = std::dynamic_pointer_cast<AST::ArrDecl>(node)) {
+    for (auto &def : n->defs) foldArrDef(def);
+  } else if (auto n = std::dynamic_pointer_cast<AST::AssignStmt>(node)) {
+    fold(n->lval);
+    n->exp = fold(n->exp);
+  } else if (auto n = std::dynamic_pointer_cast<AST::ReturnStmt>(node)) {
+    n->exp = fold(n->exp);
+  } else if (auto n = std::dynamic_pointer_cast<AST::IfStmt>(node)) {
+    n->cond = fold(n->cond);
+    n->stmt = fold(n->stmt);
+    n->else_stmt = fold(n->else_stmt);
+  } else if (auto n = std::dynamic_pointer_cast<AST::WhileStmt>(node)) {
+    n->cond = fold(n->cond);
+    n->stmt = fold(n->stmt);
+  }
+  return node;
+}
+
+void ConstFolder::foldInitVal(AST::InitValPtr node) {
+  if (!node) return;
+  for (auto &arg : node->args) {
+    if (auto sub = std::dynamic_pointer_cast<AST::InitVal>(arg))
+      foldInitVal(sub);
+    else
+      arg = fold(arg);
+  }
+}
+
+void ConstFolder::foldArrDef(AST::ArrDefPtr node) {
+  if (!node->val.has_value()) return;
+  foldInitVal(std::dynamic_pointer_cast<AST::InitVal>(node->val.value()));
+  // 初始化映像中的元素与 InitVal 中的表达式是同一批节点，折叠后同步更新
+  if (!node->image) return;
+  for (auto &run : node->image->runs)
+    for (auto &elem : run.elems) {
+      if (elem.is_const) continue;
+      elem.exp = fold(elem.exp);
+      if (auto val = const_of(elem.exp)) elem = InitElem::constant(*val);
+    }
+}
+
+AST::NodePtr ConstFolder::foldBinaryExp(AST::BinaryExpPtr node) {
+  node->left = fold(node->left);
+  node->right = fold(node->right);
+  auto lhs = const_of(node->left);
+  auto rhs = const_of(node->right);
+  auto left = node->left, right = node->right;
+
+  switch (node->op) {
+    case BinaryOp::And:
+      // 0 && x => 0，x 本来就不会被求值
+      if (lhs && !*lhs) return make_const(0, node);
+      if (lhs && rhs) return make_const(*rhs != 0, node);
+      if (rhs && !*rhs && is_pure(left)) return make_const(0, node);
+      return node;
+    case BinaryOp::Or:
+      if (lhs && *lhs) return make_const(1, node);
+      if (lhs && rhs) return make_const(*rhs != 0, node);
+      if (rhs && *rhs && is_pure(left)) return make_const(1, node);
+      return node;
+    default:
+      break;
+  }
+
+  if (lhs && rhs) {
+    if (auto val = eval_binary_op(node->op, *lhs, *rhs))
+      return make_const(*val, node);
+    return node;  // 除以零留到运行时
+  }
+
+  auto negate = [&](AST::NodePtr exp) {
+    auto res = std::make_shared<AST::UnaryExp>(BinaryOp::Sub, exp);
+    res->lineno = node->lineno;
+    return foldUnaryExp(res);
+  };
+  switch (node->op) {
+    case BinaryOp::Add:
+      if (rhs && *rhs == 0) return left;
+      if (lhs && *lhs == 0) return right;
+      break;
+    case BinaryOp::Sub:
+      if (rhs && *rhs == 0) return left;
+      break;
+    case BinaryOp::Mul:
+      if (rhs && *rhs == 1) return left;
+      if (lhs && *lhs == 1) return right;
+      if (rhs && *rhs == -1) return negate(left);
+      if (lhs && *lhs == -1) return negate(right);
+      if (rhs && *rhs == 0 && is_pure(left)) return make_const(0, node);
+      if (lhs && *lhs == 0 && is_pure(right)) return make_const(0, node);
+      break;
+    case BinaryOp::Div:
+      if (rhs && *rhs == 1) return left;
+      if (rhs && *rhs == -1) return negate(left);
+      break;
+    case BinaryOp::Mod:
+      if (rhs && (*rhs == 1 || *rhs == -1) && is_pure(left))
+        return make_const(0, node);
+      break;
+    default:
+      break;
+  }
+  return node;
+}
+
+AST::NodePtr ConstFolder::foldUnaryExp(AST::UnaryExpPtr node) {
+  node->exp = fold(node->exp);
+  if (auto val = const_of(node->exp))
+    if (auto res = eval_unary_op(node->op, *val)) return make_const(*res, node);
+  if (node->op == BinaryOp::Add) return node->exp;
+  // -(-x) => x
+  if (node->op == BinaryOp::Sub)
+    if (auto sub = std::dynamic_pointer_cast<AST::UnaryExp>(node->exp))
+      if (sub->op == BinaryOp::Sub) return sub->exp;
+  return node;
+}
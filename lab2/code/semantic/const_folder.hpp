@@ -0,0 +1,34 @@
+#ifndef SEMANTIC_CONST_FOLDER_HPP
+#define SEMANTIC_CONST_FOLDER_HPP
+
+#include "ast/tree.hpp"
+#include "const_eval.hpp"
+
+/// @brief Folds constant subexpressions and applies algebraic identities on
+/// a type-checked AST, e.g. `1+2*3` => `7`, `x*1` => `x`, `0&&f()` => `0`.
+/// Rewrites that would drop an operand only fire when the operand has no
+/// side effects (contains no function call).
+class ConstFolder {
+ public:
+  /// @brief Fold the whole tree in place
+  /// @return The number of AST nodes removed
+  int run(AST::NodePtr root);
+
+  /// @brief The number of nodes reachable from `node`
+  static int count_nodes(AST::NodePtr node);
+
+ private:
+  /// @brief Fold `node` and return the node that replaces it
+  AST::NodePtr fold(AST::NodePtr node);
+
+  AST::NodePtr foldBinaryExp(AST::BinaryExpPtr node);
+  AST::NodePtr foldUnaryExp(AST::UnaryExpPtr node);
+  void foldInitVal(AST::InitValPtr node);
+  void foldArrDef(AST::ArrDefPtr node);
+
+  /// @brief Whether evaluating `node` has no side effects
+  static bool is_pure(AST::NodePtr node);
+  static AST::NodePtr make_const(int value, AST::NodePtr from);
+};
+
+#endif  // SEMANTIC_CONST_FOLDER_HPP
@@ -0,0 +1,80 @@
+#include "initializer.hpp"
+
+#include <algorithm>
+
+#include "ast/tree.hpp"
+#include "common.hpp"
+
+void InitImage::append(int64_t offset, InitElem elem) {
+  ASSERT(runs.empty() || runs.back().end() <= offset,
+         "Initializer elements must be appended in order");
+  if (runs.empty() || runs.back().end() != offset)
+    runs.push_back(InitRun{offset, {}});
+  runs.back().elems.push_back(elem);
+}
+
+int64_t InitImage::count() const {
+  int64_t cnt = 0;
+  for (auto &run : runs) cnt += run.elems.size();
+  return cnt;
+}
+
+bool InitImage::all_const() const {
+  for (auto &run : runs)
+    for (auto &elem : run.elems)
+      if (!elem.is_const) return false;
+  return true;
+}
+
+std::optional<int> InitImage::const_at(int64_t offset) const {
+  // 找到第一个 end() > offset 的 run
+  auto it = std::upper_bound(
+      runs.begin(), runs.end(), offset,
+      [](int64_t off, const InitRun &run) { return off < run.end(); });
+  if (it == runs.end() || it->offset > offset) return 0;
+  auto &elem = it->elems[offset - it->offset];
+  if (!elem.is_const) return std::nullopt;
+  return elem.value;
+}
+
+InitImagePtr InitFlattener::flatten(AST::InitValPtr init, std::string name) {
+  this->name = name;
+  image = InitImage::create(layout.size);
+  if (!init) return image;
+  if (init->is_exp)
+    ASSERT(false, "Array initializer of " + name +
+                      " must be an initializer list");
+  flatten_list(init, 0, 0);
+  return image;
+}
+
+void InitFlattener::flatten_list(AST::InitValPtr list, size_t level,
+                                 int64_t base) {
+  // list 初始化 [base, base + span(level)) 这一段元素
+  int64_t end = base + layout.span(level);
+  int64_t pos = base;
+  size_t scalar_level = layout.rank();
+  for (auto &item : list->args) {
+    ASSERT(pos < end, "Excess elements in array initializer of " + name);
+    auto sub = std::dynamic_pointer_cast<AST::InitVal>(item);
+    if (sub && !sub->is_exp) {
+      // 嵌套的花括号初始化当前位置对齐的最大子数组
+      ASSERT(level < scalar_level,
+             "Too many braces around scalar initializer of " + name);
+      size_t sub_level = level + 1;
+      while (sub_level < scalar_level && pos % layout.span(sub_level) != 0)
+        sub_level++;
+      flatten_list(sub, sub_level, pos);
+      pos += layout.span(sub_level);
+      continue;
+    }
+    auto exp = sub ? sub->args[0] : item;
+    if (auto n = std::dynamic_pointer_cast<AST::IntConst>(exp)) {
+      // 零值元素不需要存储
+      if (n->value != 0) image->append(pos, InitElem::constant(n->value));
+    } else {
+      image->append(pos, InitElem::expr(exp));
+    }
+    pos++;
+  }
+}
@@ -0,0 +1,92 @@
+#ifndef SEMANTIC_INITIALIZER_HPP
+#define SEMANTIC_INITIALIZER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "type.hpp"
+
+namespace AST {
+class Node;
+class InitVal;
+}  // namespace AST
+
+/// @brief One explicitly initialized element of an array
+struct InitElem {
+  /// @brief Whether the element is a compile-time constant
+  bool is_const;
+  /// @brief The value of a constant element
+  int value;
+  /// @brief The expression of a non-constant element, evaluated at run time
+  std::shared_ptr<AST::Node> exp;
+
+  static InitElem constant(int value) { return {true, value, nullptr}; }
+  static InitElem expr(std::shared_ptr<AST::Node> exp) {
+    return {false, 0, exp};
+  }
+};
+
+/// @brief A run of consecutive initialized elements starting at `offset`
+struct InitRun {
+  int64_t offset;
+  std::vector<InitElem> elems;
+
+  int64_t end() const { return offset + (int64_t)elems.size(); }
+};
+
+class InitImage;
+using InitImagePtr = std::shared_ptr<InitImage>;
+/// @brief Flattened, row-major image of an array initializer.
+/// Only explicitly initialized non-zero elements are stored, as runs sorted
+/// by offset; every element not covered by a run is zero.
+class InitImage {
+ public:
+  /// @brief The total number of elements of the array
+  int64_t size;
+  /// @brief The initialized runs, sorted by offset and non-overlapping
+  std::vector<InitRun> runs;
+
+  InitImage(int64_t size) : size(size) {}
+  static InitImagePtr create(int64_t size) {
+    return std::make_shared<InitImage>(size);
+  }
+
+  /// @brief Append an element, offsets must be strictly increasing
+  void append(int64_t offset, InitElem elem);
+
+  /// @brief The number of explicitly stored elements
+  int64_t count() const;
+
+  /// @brief Whether every stored element is a compile-time constant
+  bool all_const() const;
+
+  /// @brief The constant at `offset`, 0 for implicit zeros
+  /// @return std::nullopt if the element is a run-time expression
+  std::optional<int> const_at(int64_t offset) const;
+};
+
+/// @brief Validates and flattens a `{...}` initializer in a single pass
+/// over its elements, following the C rule that a nested brace initializes
+/// the largest sub-array the current position is aligned to.
+class InitFlattener {
+ public:
+  /// @param layout The layout of the initialized array
+  InitFlattener(const ArrayLayout &layout) : layout(layout) {}
+
+  /// @brief Flatten `init` into a sparse image
+  /// @param name The name of the array, used in error messages
+  InitImagePtr flatten(std::shared_ptr<AST::InitVal> init, std::string name);
+
+ private:
+  const ArrayLayout &layout;
+  InitImagePtr image;
+  std::string name;
+
+  void flatten_list(std::shared_ptr<AST::InitVal> list, size_t level,
+                    int64_t base);
+};
+
+#endif  // SEMANTIC_INITIALIZER_HPP
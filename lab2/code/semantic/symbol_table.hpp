@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "initializer.hpp"
 #include "type.hpp"
 
 class Symbol;
@@ -22,9 +23,20 @@ class Symbol {
 	int depth;
 	/// @brief The symbol is defined
 	bool is_defined = false;
+	/// @brief The layout of an array symbol, nullptr otherwise
+	ArrayLayoutPtr layout;
+	/// @brief The symbol is declared `const`
+	bool is_const = false;
+	/// @brief The value of a `const` scalar
+	int const_value = 0;
+	/// @brief The initializer of a `const` array
+	InitImagePtr const_image;
 
   Symbol(std::string name, TypePtr type, int depth, bool is_defined) 
-							: name(name), type(type), depth(depth), is_defined(is_defined) {}
+							: name(name), type(type), depth(depth), is_defined(is_defined) {
+		if(auto arr_type = std::dynamic_pointer_cast<ArrayType>(type))
+			layout = ArrayLayout::create(arr_type);
+	}
   static SymbolPtr create(std::string name, TypePtr type, int depth, bool is_defined) {
     return std::make_shared<Symbol>(name, type, depth, is_defined);
   }
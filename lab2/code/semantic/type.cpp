@@ -1,5 +1,7 @@
 #include "type.hpp"
 
+#include <climits>
+
 #include "common.hpp"
 
 bool PrimitiveType::equals(const TypePtr& other) const {
@@ -21,6 +23,29 @@ bool ArrayType::equals(const TypePtr& other) const {
 
   return true;
 }
+ArrayLayout::ArrayLayout(const ArrayTypePtr& type)
+    : dims(type->dims),
+      unknown_first(type->dims[0] == ArrayType::kUnknownDim) {
+  strides.assign(dims.size(), 1);
+  for (size_t k = dims.size() - 1; k-- > 0;) {
+    ASSERT(dims[k + 1] > 0, "Array dimension should be greater than 0");
+    strides[k] = strides[k + 1] * dims[k + 1];
+    ASSERT(strides[k] <= INT_MAX, "Array is too large");
+  }
+  ASSERT(unknown_first || dims[0] > 0,
+         "Array dimension should be greater than 0");
+  size = unknown_first ? 0 : dims[0] * strides[0];
+  ASSERT(size <= INT_MAX, "Array is too large");
+
+  // 预先构造按 k 个下标索引后的类型，避免每次访问都分配新的 ArrayType
+  sub_types.push_back(type);
+  for (size_t k = 1; k < dims.size(); k++) {
+    std::vector<int> rest(dims.begin() + k, dims.end());
+    sub_types.push_back(ArrayType::create(type->element_type, rest));
+  }
+  sub_types.push_back(type->element_type);
+}
+
 bool FuncType::equals(const TypePtr& other) const {
   auto other_type = std::dynamic_pointer_cast<FuncType>(other);
   if (!other_type || !return_type->equals(other_type->return_type) ||
@@ -5,6 +5,7 @@
 #define ARRAY 2
 #define FUNC 3
 
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -50,6 +51,9 @@ class ArrayType;
 using ArrayTypePtr = std::shared_ptr<ArrayType>;
 class ArrayType : public Type {
  public:
+  /// @brief The first dimension of an array parameter, e.g. `int a[][3]`
+  static constexpr int kUnknownDim = -1;
+
   TypePtr element_type;
   std::vector<int> dims;
 
@@ -67,13 +71,50 @@ class ArrayType : public Type {
   std::string to_string() const override {
     std::string result = element_type->to_string() + " (*)";
     for (size_t i = 0; i < dims.size(); i++) {
-      result += "[" + std::to_string(dims[i]) + "]";
+      if (dims[i] == kUnknownDim)
+        result += "[]";
+      else
+        result += "[" + std::to_string(dims[i]) + "]";
     }
     return result;
   }
 	int which_type() const override { return ARRAY; };
 };
 
+class ArrayLayout;
+using ArrayLayoutPtr = std::shared_ptr<ArrayLayout>;
+/// @brief Row-major layout of an array, computed once per array symbol so
+/// that index arithmetic never has to walk or copy the dimension list
+class ArrayLayout {
+ public:
+  /// @brief The dimensions, dims[0] may be ArrayType::kUnknownDim
+  std::vector<int> dims;
+  /// @brief strides[k] is the distance in elements between a[i] and a[i+1]
+  /// at dimension k, strides[dims.size() - 1] is 1
+  std::vector<int64_t> strides;
+  /// @brief The total number of elements, 0 if the first dimension is unknown
+  int64_t size;
+  /// @brief Whether the first dimension is unknown (array parameters)
+  bool unknown_first;
+  /// @brief sub_types[k] is the type of the array indexed by k subscripts
+  std::vector<TypePtr> sub_types;
+
+  ArrayLayout(const ArrayTypePtr& type);
+
+  static ArrayLayoutPtr create(const ArrayTypePtr& type) {
+    return std::make_shared<ArrayLayout>(type);
+  }
+
+  /// @brief The number of dimensions
+  size_t rank() const { return dims.size(); }
+
+  /// @brief The number of elements covered by the sub-array at dimension k
+  int64_t span(size_t k) const { return k == 0 ? size : strides[k - 1]; }
+
+  /// @brief The type of the array indexed by n subscripts, n <= rank()
+  TypePtr indexed_type(size_t n) const { return sub_types[n]; }
+};
+
 class FuncType;
 using FuncTypePtr = std::shared_ptr<FuncType>;
 class FuncType : public Type {
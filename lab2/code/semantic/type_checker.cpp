@@ -83,9 +83,10 @@ TypePtr TypeChecker::checkFuncDef(AST::FuncDefPtr node) {
 		{
 			if(param->is_arr)
 			{
-				std::vector<int> dims;
+				std::vector<int> dims = {ArrayType::kUnknownDim};
+				checkArrLists(param->args);
 				for(auto dim : param->args->args)
-					dims.push_back(dim->value);
+					dims.push_back(std::dynamic_pointer_cast<AST::IntConst>(dim)->value);
 				auto dim_type = PrimitiveType::create(param->btype);
 				auto dims_type = ArrayType::create(dim_type, dims);
 				param_types.push_back(dims_type);
@@ -101,12 +102,14 @@ TypePtr TypeChecker::checkFuncDef(AST::FuncDefPtr node) {
 	symbol_table->enter_scope();
 	symbol_table = symbol_table->next;
 	if(node->is_param)
-		for(auto param : node->params->args)
+		for(size_t i = 0; i < node->params->args.size(); i++)
 		{
-			auto param_type = PrimitiveType::create(param->btype);
-			auto param_symbol = symbol_table->add_symbol(param->name, param_type);
+			auto param = node->params->args[i];
+			param->symbol = symbol_table->add_symbol(param->name, param_types[i]);
 		}
+	in_func = true;
 	checkBlock(node->block, false);
+	in_func = false;
 	symbol_table->exit_scope();
 	symbol_table = symbol_table->parent;
   return type;
@@ -114,12 +117,12 @@ TypePtr TypeChecker::checkFuncDef(AST::FuncDefPtr node) {
 
 TypePtr TypeChecker::checkVarDecl(AST::VarDeclPtr node) {
   for (auto var_def : node->defs) {
-    checkVarDef(var_def, node->btype);
+    checkVarDef(var_def, node->btype, node->is_const);
   }
   return nullptr;
 }
 
-TypePtr TypeChecker::checkVarDef(AST::VarDefPtr node, BasicType var_type) {
+TypePtr TypeChecker::checkVarDef(AST::VarDefPtr node, BasicType var_type, bool is_const) {
   // 你需要判断变量是否已经被定义过，并更新符号表
   auto type = PrimitiveType::create(var_type);
   // 判断变量是否已经被定义过
@@ -141,17 +144,30 @@ TypePtr TypeChecker::checkVarDef(AST::VarDefPtr node, BasicType var_type) {
 	
 	if(node->val.has_value())
 		check(node->val.value());
+	// 常量和全局变量的初始值必须是常量表达式
+	if(is_const || !in_func)
+	{
+		if(is_const && !node->val.has_value())
+			ASSERT(false, "Const " + node->ident + " is not initialized");
+		std::optional<int> val = 0;
+		if(node->val.has_value())
+			val = const_eval.eval(node->val.value());
+		if(!val)
+			ASSERT(false, "Initializer of " + node->ident + " is not a constant expression");
+		node->symbol->is_const = is_const;
+		node->symbol->const_value = *val;
+	}
   return PrimitiveType::Void;
 }
 
 TypePtr TypeChecker::checkArrDecl(AST::ArrDeclPtr node) {
   for (auto arr_def : node->defs) {
-    checkArrDef(arr_def, node->btype);
+    checkArrDef(arr_def, node->btype, node->is_const);
   }
   return nullptr;
 }
 
-TypePtr TypeChecker::checkArrDef(AST::ArrDefPtr node, BasicType var_type) {
+TypePtr TypeChecker::checkArrDef(AST::ArrDefPtr node, BasicType var_type, bool is_const) {
   // 你需要判断变量是否已经被定义过，并更新符号表
   auto type = PrimitiveType::create(var_type);
   // 判断变量是否已经被定义过
@@ -171,31 +187,71 @@ TypePtr TypeChecker::checkArrDef(AST::ArrDefPtr node, BasicType var_type) {
 	std::vector<int> nums = {};
 	auto dims = std::dynamic_pointer_cast<AST::ArrLists>(node->arr);
 	for(auto dim : dims->args){
-		nums.push_back(dim->value);
+		nums.push_back(std::dynamic_pointer_cast<AST::IntConst>(dim)->value);
 	}
 	auto arr_type = ArrayType::create(type, nums);
   // 将变量插入符号表，并将符号表中的 symbol 挂到 VarDef 节点上
   node->symbol = symbol_table->add_symbol(node->ident, arr_type);
 
-	AST::ArrListsPtr arr_rev;
-	arr_rev = node->arr;
-	std::reverse(arr_rev->args.begin(), arr_rev->args.end());
 	if(node->val.has_value())
 	{
-		TypePtr type;
-		type = checkInitVal(std::dynamic_pointer_cast<AST::InitVal>(node->val.value()), arr_rev, 0, node->to_string());
-		if(type->equals(PrimitiveType::Int))
-			ASSERT(false, "Array initializer must be an initializer list");
+		// 一次线性扫描把初始化列表展开成稀疏的初始化映像
+		auto init = std::dynamic_pointer_cast<AST::InitVal>(node->val.value());
+		node->image = InitFlattener(*node->symbol->layout).flatten(init, node->ident);
+		for(auto &run : node->image->runs)
+			for(auto &elem : run.elems)
+			{
+				if(elem.is_const)	continue;
+				if(!checkExp(elem.exp)->equals(PrimitiveType::Int))
+					ASSERT(false, "type of array value is not int");
+				if(auto val = const_eval.eval(elem.exp))
+					elem = InitElem::constant(*val);
+			}
 	}
-		return PrimitiveType::Void;
+	if(is_const && !node->val.has_value())
+		ASSERT(false, "Const array " + node->ident + " is not initialized");
+	if((is_const || !in_func) && node->image && !node->image->all_const())
+		ASSERT(false, "Initializer of " + node->ident + " is not a constant expression");
+	if(is_const)
+	{
+		node->symbol->is_const = true;
+		node->symbol->const_image = node->image;
+	}
+	return PrimitiveType::Void;
 }
 
 TypePtr TypeChecker::checkArrLists(AST::ArrListsPtr node) {
-	for(auto item : node->args)
-		check(item);
+	// 每一维都必须是正的常量表达式，求值后替换为 IntConst
+	for(auto &item : node->args)
+	{
+		if(!check(item)->equals(PrimitiveType::Int))
+			ASSERT(false, "array dim is not int");
+		auto val = const_eval.eval(item);
+		if(!val)
+			ASSERT(false, "Array dimension is not a constant expression");
+		if(*val <= 0)
+			ASSERT(false, "Array dimension should be greater than 0");
+		item = makeIntConst(*val, item->lineno);
+	}
 	return PrimitiveType::Void;
 }
 
+TypePtr TypeChecker::checkExp(AST::NodePtr &exp) {
+	auto type = check(exp);
+	// 读取常量时直接替换为常量的值
+	if(auto lval = std::dynamic_pointer_cast<AST::LVal>(exp))
+		if(lval->symbol->is_const)
+			if(auto val = const_eval.eval(lval))
+				exp = makeIntConst(*val, lval->lineno);
+	return type;
+}
+
+AST::IntConstPtr TypeChecker::makeIntConst(int value, int lineno) {
+	auto node = std::make_shared<AST::IntConst>(value);
+	node->lineno = lineno;
+	return node;
+}
+
 TypePtr TypeChecker::checkBlock(AST::BlockPtr node, bool new_scope) {
   // 检查块内的每个语句
   // 如果 new_scope 为 true
@@ -219,7 +275,9 @@ TypePtr TypeChecker::checkBlock(AST::BlockPtr node, bool new_scope) {
 
 TypePtr TypeChecker::checkAssignStmt(AST::AssignStmtPtr node) {
   TypePtr lval_type = check(node->lval);
-  TypePtr expr_type = check(node->exp);
+  TypePtr expr_type = checkExp(node->exp);
+	if(node->lval->symbol->is_const)
+		ASSERT(false, "Cannot assign to const " + node->lval->name);
   // 判断赋值号两边的类型是否相同
   // 我们实验中只支持 int 类型
   // 因此你需要判断 lval_type 和 expr_type 是否都为 int 类型
@@ -231,7 +289,7 @@ TypePtr TypeChecker::checkAssignStmt(AST::AssignStmtPtr node) {
 }
 
 TypePtr TypeChecker::checkReturnStmt(AST::ReturnStmtPtr node) {
-  TypePtr expr_type = check(node->exp);
+  TypePtr expr_type = node->is_void ? PrimitiveType::Void : checkExp(node->exp);
   // 判断返回值类型是否和函数声明的返回值类型相同
 	if(expr_type->equals(func_ret_type))
 	  return nullptr;
@@ -240,7 +298,7 @@ TypePtr TypeChecker::checkReturnStmt(AST::ReturnStmtPtr node) {
 }
 
 TypePtr TypeChecker::checkIfStmt(AST::IfStmtPtr node) {
-	TypePtr cond_type = check(node->cond);
+	TypePtr cond_type = checkExp(node->cond);
 	TypePtr if_type = check(node->stmt);
 	if(node->else_stmt)
 		TypePtr else_type = check(node->else_stmt);
@@ -251,7 +309,7 @@ TypePtr TypeChecker::checkIfStmt(AST::IfStmtPtr node) {
 }
 
 TypePtr TypeChecker::checkWhileStmt(AST::WhileStmtPtr node) {
-	TypePtr cond_type = check(node->cond);
+	TypePtr cond_type = checkExp(node->cond);
 	TypePtr stmt_type = check(node->stmt);
 	if(cond_type->equals(PrimitiveType::Int))
 		return PrimitiveType::Void;
@@ -263,65 +321,11 @@ TypePtr TypeChecker::checkNullStmt(AST::NullStmtPtr node) {
 	return PrimitiveType::Void;
 }
 
-TypePtr TypeChecker::checkInitVal(AST::InitValPtr node, std::optional<AST::ArrListsPtr> arr, int checked_cnt, std::string str) {
-
-	if(!node)	return PrimitiveType::Void;
-	// auto init_node = std::dynamic_pointer_cast<AST::InitVal>(node);
-
-	if(!arr.has_value())
-		if(node->args.size()!=1)
-			ASSERT(false, "Excess elements in scalar initializer " + str + " " + std::to_string(node->args.size()));
-		else
-			return check(node->args[0]);
-	if(node->is_exp)
-		if(check(node->args[0])->equals(PrimitiveType::Int))
-			return PrimitiveType::Int;
-		else
-			ASSERT(false, "type of array value is not int");
-	if(!node->args.size())	return PrimitiveType::Void;
-	int count = checked_cnt;
-	int capacity = 1;
-	std::vector<AST::IntConstPtr> arr_list = arr.value()->args;
-	for(auto item : arr_list)
-		capacity *= item->value;
-
-	for(auto item : node->args)
-	{
-		if(auto n = std::dynamic_pointer_cast<AST::InitVal>(item))
-		{
-			int arr_size = 1;
-			int i=0;
-			auto sub_arr = new AST::ArrLists();
-			for(i=0; i<arr_list.size()-1;i++)
-			{
-				arr_size *= arr_list[i]->value;
-				if(count % arr_size != 0)
-				{
-					break;
-				}else{
-					sub_arr->args.push_back(arr_list[i]);
-				}
-			}
-			checkInitVal(n, AST::ArrListsPtr(sub_arr), count, str);
-			if(i!=arr_list.size()-1)	arr_size /= arr_list[i]->value;
-			count += arr_size;
-			ASSERT((count-checked_cnt)<=capacity, "Excess elements in array initializer");
-		}else{
-			count++;
-			ASSERT((count-checked_cnt)<=capacity, "Excess elements in array initializer");
-
-			if(!check(item)->equals(PrimitiveType::Int))
-				ASSERT(false, "type of array value is not int");
-		}
-	}
-	std::vector<int> dims;
-	if(arr.has_value())
-		for(auto i:arr.value()->args)
-			dims.push_back(i->value);
-	if(!dims.size())
-		return PrimitiveType::Int;
-	else
-		return ArrayType::create(PrimitiveType::Int, dims);
+TypePtr TypeChecker::checkInitVal(AST::InitValPtr node) {
+	// 数组的初始化列表由 checkArrDef 展开检查，这里只会遇到标量的初始化
+	if(node->args.size() != 1)
+		ASSERT(false, "Excess elements in scalar initializer " + std::to_string(node->args.size()));
+	return checkExp(node->args[0]);
 }
 
 TypePtr TypeChecker::checkLVal(AST::LValPtr node) {
@@ -340,30 +344,26 @@ TypePtr TypeChecker::checkLVal(AST::LValPtr node) {
 	auto type = symbol->type;
 	if(!node->is_arr)
 		return type;
-	if(type->which_type() == PRIMI)
+	if(!symbol->layout)
 	{
 		ASSERT(false, "LVal " + node->to_string() + " is not a array");
 		return nullptr;
 	}
 
 	auto index = std::dynamic_pointer_cast<AST::ExpList>(node->index);
-	auto arr_type = std::dynamic_pointer_cast<ArrayType>(type);
-	for(auto item : index->args)
-		if(!(check(item))->equals(PrimitiveType::Int))
+	for(auto &item : index->args)
+		if(!(checkExp(item))->equals(PrimitiveType::Int))
 		{
 			ASSERT(false, "array dim is not int");
 		}
 
-	if(index->args.size() > arr_type->dims.size())
+	auto &layout = symbol->layout;
+	if(index->args.size() > layout->rank())
 	{
 		ASSERT(false, "Array too many indexes");
 		return nullptr;
-	}else if(index->args.size() == arr_type->dims.size()){
-		return arr_type->element_type;
-	}else{
-		std::vector<int> dims(arr_type->dims.begin() + index->args.size(), arr_type->dims.end());
-		return ArrayType::create(arr_type->element_type, dims);
 	}
+	return layout->indexed_type(index->args.size());
 }
 
 TypePtr TypeChecker::checkIntConst(AST::IntConstPtr node) {
@@ -396,9 +396,8 @@ TypePtr TypeChecker::checkFuncCall(AST::FuncCallPtr node) {
 	
 	for(int i=0; i<type->param_types.size(); i++)
 	{
-		auto item1 = node->args[i];
 		auto item2 = type->param_types[i];
-		auto item_type = check(item1);
+		auto item_type = checkExp(node->args[i]);
 		if(!item_type->equals(item2))
 		{
 			ASSERT(false, "funcion call element "+std::to_string(i)+" type "+item_type->to_string()+" "+type->param_types[i]->to_string()+" is not equal");
@@ -411,7 +410,7 @@ TypePtr TypeChecker::checkFuncCall(AST::FuncCallPtr node) {
 }
 
 TypePtr TypeChecker::checkUnaryExp(AST::UnaryExpPtr node) {
-  auto type = check(node->exp);
+  auto type = checkExp(node->exp);
   // 一元表达式只支持 int 类型，因此你需要判断 type 是否为 int
 	if(type->equals(PrimitiveType::Int))
 	  return PrimitiveType::Int;
@@ -420,8 +419,8 @@ TypePtr TypeChecker::checkUnaryExp(AST::UnaryExpPtr node) {
 }
 
 TypePtr TypeChecker::checkBinaryExp(AST::BinaryExpPtr node) {
-  TypePtr left_type = check(node->left);
-  TypePtr right_type = check(node->right);
+  TypePtr left_type = checkExp(node->left);
+  TypePtr right_type = checkExp(node->right);
   // 二元表达式只支持 int 类型，因此你需要判断左右表达式的类型是否为 int
 
 	if(left_type->equals(PrimitiveType::Int) && right_type->equals(PrimitiveType::Int))
@@ -2,9 +2,10 @@
 #define SEMANTIC_TYPE_CHECKER_HPP
 
 #include <memory>
-#include <algorithm>
 
 #include "ast/tree.hpp"
+#include "const_eval.hpp"
+#include "initializer.hpp"
 #include "symbol_table.hpp"
 
 class TypeChecker {
@@ -19,10 +20,18 @@ class TypeChecker {
  private:
   /// @brief The symbol table
   SymbolTablePtr symbol_table = std::make_shared<SymbolTable>();
+	/// @brief Whether a function body is being checked
+	bool in_func = false;
+	ConstEvaluator const_eval;
+
+	/// @brief Check an expression stored in `exp`, replacing it by an
+	/// IntConst if it reads a constant
+	TypePtr checkExp(AST::NodePtr &exp);
+	AST::IntConstPtr makeIntConst(int value, int lineno);
 
   TypePtr checkIntConst(AST::IntConstPtr node);
   TypePtr checkLVal(AST::LValPtr node);
-	TypePtr checkInitVal(AST::InitValPtr node, std::optional<AST::ArrListsPtr> arr = std::nullopt, int checked_cnt = 0, std::string str="error");
+  TypePtr checkInitVal(AST::InitValPtr node);
   TypePtr checkUnaryExp(AST::UnaryExpPtr node);
   TypePtr checkBinaryExp(AST::BinaryExpPtr node);
   TypePtr checkFuncCall(AST::FuncCallPtr node);
@@ -32,9 +41,9 @@ class TypeChecker {
 	TypePtr checkIfStmt(AST::IfStmtPtr node);
 	TypePtr checkWhileStmt(AST::WhileStmtPtr node);
 	TypePtr checkNullStmt(AST::NullStmtPtr node);
-  TypePtr checkVarDef(AST::VarDefPtr node, BasicType var_type);
+  TypePtr checkVarDef(AST::VarDefPtr node, BasicType var_type, bool is_const = false);
   TypePtr checkVarDecl(AST::VarDeclPtr node);
-	TypePtr checkArrDef(AST::ArrDefPtr node, BasicType var_type = BasicType::Int);
+	TypePtr checkArrDef(AST::ArrDefPtr node, BasicType var_type = BasicType::Int, bool is_const = false);
   TypePtr checkArrDecl(AST::ArrDeclPtr node);
 	TypePtr checkArrLists(AST::ArrListsPtr node);
   TypePtr checkFuncDef(AST::FuncDefPtr node);
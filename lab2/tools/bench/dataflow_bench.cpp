@@ -0,0 +1,250 @@
+// Timing driver for the dataflow analyses, kept out of code/ so that the
+// compiler sources have a single main. It generates functions with
+// thousands of blocks and values, then times liveness, reaching
+// definitions and available expressions on each one. Liveness is also
+// compared with a naive solver over std::set. From lab2, as one command:
+//
+//   g++ -std=c++17 -O2 -Icode -o dataflow_bench tools/bench/dataflow_bench.cpp
+//       code/analysis/cfg.cpp code/analysis/dataflow.cpp
+//       code/analysis/liveness.cpp code/analysis/reaching_defs.cpp
+//       code/analysis/available_exprs.cpp code/analysis/dominators.cpp
+//       code/ir/ir.cpp code/ir/verifier.cpp code/semantic/const_eval.cpp
+//       code/semantic/type.cpp code/semantic/initializer.cpp code/ast/tree.cpp
+//       && ./dataflow_bench
+//
+// The arguments are the numbers of regions to generate, 100 1000 3000 by
+// default. Every region is one of: a run of arithmetic and memory
+// accesses, an if/else diamond merged by a phi, or a counted loop.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "analysis/available_exprs.hpp"
+#include "analysis/liveness.hpp"
+#include "analysis/reaching_defs.hpp"
+#include "ir/verifier.hpp"
+
+using namespace IR;
+
+/// @brief Builds a random function region by region. Values that
+/// dominate the current point are kept in a pool, so operands can come
+/// from far back and stay live across many blocks.
+class CFGBuilder {
+ public:
+  static constexpr size_t kPoolSize = 64;
+  static constexpr int kArraySize = 64;
+
+  CFGBuilder(Module &module, unsigned seed) : module(module), rng(seed) {
+    array = module.add_global(Global{"a", kArraySize, true, false,
+                                     InitImage::create(kArraySize)});
+  }
+
+  FunctionPtr build(int regions) {
+    func = Function::create("bench", IR::Type::I32,
+                            {IR::Type::I32, IR::Type::I32});
+    auto &f = *func;
+    cur = f.add_block();
+    pool = {f.args[0], f.args[1]};
+    // 所有访问共用入口块里的地址，同一元素的写才能互相覆盖
+    elements.clear();
+    for (int i = 0; i < kArraySize; i++)
+      elements.push_back(element(f.const_int(i)));
+    for (int r = 0; r < regions; r++) {
+      switch (rng() % 3) {
+        case 0: straight(); break;
+        case 1: diamond(); break;
+        default: loop(); break;
+      }
+    }
+    ValueId sum = pick();
+    for (int i = 0; i < 4; i++) sum = emit(Opcode::Add, {sum, pick()});
+    emit(Opcode::Ret, {sum}, {}, IR::Type::Void);
+    return func;
+  }
+
+ private:
+  Module &module;
+  std::mt19937 rng;
+  int array;
+  FunctionPtr func;
+  BlockId cur = 0;
+  std::vector<ValueId> pool;
+  std::vector<ValueId> elements;
+
+  ValueId emit(Opcode op, const std::vector<ValueId> &ops,
+               const std::vector<BlockId> &targets = {},
+               IR::Type type = IR::Type::I32) {
+    ValueId v = func->create(op, type, ops, targets);
+    func->append(cur, v);
+    return v;
+  }
+  ValueId pick() { return pool[rng() % pool.size()]; }
+  void keep(ValueId v) {
+    if (pool.size() == kPoolSize) pool.erase(pool.begin() + rng() % 4);
+    pool.push_back(v);
+  }
+  ValueId element(ValueId index) {
+    return emit(Opcode::Gep, {func->global_addr(array), index}, {},
+                IR::Type::Ptr);
+  }
+  ValueId element() { return elements[rng() % kArraySize]; }
+  ValueId arith() {
+    static const Opcode ops[] = {Opcode::Add, Opcode::Sub, Opcode::Mul,
+                                 Opcode::Lt, Opcode::Eq};
+    return emit(ops[rng() % 5], {pick(), pick()});
+  }
+
+  void straight() {
+    for (int i = 0; i < 3; i++) keep(arith());
+    keep(emit(Opcode::Load, {element()}));
+    emit(Opcode::Store, {pick(), element()}, {}, IR::Type::Void);
+  }
+
+  void diamond() {
+    auto &f = *func;
+    BlockId arms[2] = {f.add_block(), f.add_block()}, join = f.add_block();
+    emit(Opcode::CondBr, {emit(Opcode::Lt, {pick(), pick()})},
+         {arms[0], arms[1]}, IR::Type::Void);
+    ValueId results[2];
+    for (int side = 0; side < 2; side++) {
+      cur = arms[side];
+      results[side] = emit(Opcode::Add, {arith(), pick()});
+      if (rng() % 2)
+        emit(Opcode::Store, {results[side], element()}, {}, IR::Type::Void);
+      emit(Opcode::Br, {}, {join}, IR::Type::Void);
+    }
+    cur = join;
+    ValueId phi = f.create(Opcode::Phi, IR::Type::I32);
+    f.append(join, phi);
+    f.add_incoming(phi, results[0], arms[0]);
+    f.add_incoming(phi, results[1], arms[1]);
+    keep(phi);
+  }
+
+  void loop() {
+    auto &f = *func;
+    BlockId pre = cur, body = f.add_block(), exit = f.add_block();
+    ValueId init = pick();
+    emit(Opcode::Br, {}, {body}, IR::Type::Void);
+    cur = body;
+    ValueId i = f.create(Opcode::Phi, IR::Type::I32);
+    ValueId acc = f.create(Opcode::Phi, IR::Type::I32);
+    f.append(body, i);
+    f.append(body, acc);
+    ValueId x = emit(Opcode::Load, {element(i)});
+    ValueId product = emit(Opcode::Mul, {acc, x});
+    ValueId next_acc = emit(Opcode::Add, {product, pick()});
+    emit(Opcode::Store, {next_acc, element(i)}, {}, IR::Type::Void);
+    ValueId next = emit(Opcode::Add, {i, f.const_int(1)});
+    ValueId bound = f.const_int(2 + rng() % (kArraySize - 2));
+    emit(Opcode::CondBr, {emit(Opcode::Lt, {next, bound})}, {body, exit},
+         IR::Type::Void);
+    f.add_incoming(i, f.const_int(0), pre);
+    f.add_incoming(i, next, body);
+    f.add_incoming(acc, init, pre);
+    f.add_incoming(acc, next_acc, body);
+    cur = exit;
+    keep(acc);
+  }
+};
+
+/// @brief Liveness by iterating std::set equations to a fixpoint
+/// @return the number of (block, value) pairs on which the two disagree
+static long naiveMismatches(const Function &f, const CFG &cfg,
+                            const Liveness &live) {
+  size_t n = f.num_blocks();
+  std::vector<std::set<ValueId>> in(n), out(n);
+  auto tracked = [&](ValueId v) { return live.bit(v) != Liveness::kNoBit; };
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto it = cfg.rpo.rbegin(); it != cfg.rpo.rend(); ++it) {
+      BlockId bb = *it;
+      std::set<ValueId> o;
+      for (auto succ : cfg.succs[bb]) {
+        o.insert(in[succ].begin(), in[succ].end());
+        for (auto id : f.blocks[succ].insts) {
+          if (f[id].op != Opcode::Phi) break;
+          ValueId v = f.incoming(id, bb);
+          if (tracked(v)) o.insert(v);
+        }
+      }
+      std::set<ValueId> i = o;
+      auto &insts = f.blocks[bb].insts;
+      for (auto k = insts.rbegin(); k != insts.rend(); ++k) {
+        i.erase(*k);
+        auto &inst = f[*k];
+        if (inst.op == Opcode::Phi) continue;
+        for (uint32_t j = 0; j < inst.num_ops; j++)
+          if (tracked(inst.ops[j])) i.insert(inst.ops[j]);
+      }
+      if (i != in[bb] || o != out[bb]) {
+        in[bb] = std::move(i);
+        out[bb] = std::move(o);
+        changed = true;
+      }
+    }
+  }
+  long bad = 0;
+  for (auto bb : cfg.rpo)
+    for (ValueId v = 0; v < f.insts.size(); v++) {
+      if (!tracked(v)) continue;
+      bad += live.live_in(bb, v) != (bool)in[bb].count(v);
+      bad += live.live_out(bb, v) != (bool)out[bb].count(v);
+    }
+  return bad;
+}
+
+int main(int argc, char **argv) {
+  std::vector<int> sizes;
+  for (int i = 1; i < argc; i++) sizes.push_back(atoi(argv[i]));
+  if (sizes.empty()) sizes = {100, 1000, 3000};
+
+  auto ms = [](auto from, auto to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+  };
+  printf("%8s %7s %7s | %9s %9s %9s | %s\n", "regions", "blocks", "values",
+         "live ms", "reach ms", "avail ms", "check");
+  bool ok = true;
+  for (int regions : sizes) {
+    auto module = Module::create();
+    CFGBuilder builder(*module, regions);
+    auto func = builder.build(regions);
+    module->add_function(func);
+    auto &f = *func;
+    Verifier verifier;
+    if (!verifier.verify(*module)) {
+      printf("generated invalid IR:\n%s\n", verifier.message().c_str());
+      return 1;
+    }
+
+    CFG cfg(f);
+    auto t0 = std::chrono::steady_clock::now();
+    Liveness live(f, cfg);
+    auto t1 = std::chrono::steady_clock::now();
+    ReachingDefinitions reach(f, cfg);
+    auto t2 = std::chrono::steady_clock::now();
+    AvailableExpressions avail(f, cfg);
+    auto t3 = std::chrono::steady_clock::now();
+
+    // 查询一遍结果，顺便确认两个分析都能用
+    long reaching = 0, available = 0;
+    for (auto bb : cfg.rpo)
+      for (auto id : f.blocks[bb].insts) {
+        if (f[id].op == Opcode::Load) reaching += reach.reaching(id).size();
+        if (avail.expr(id) != AvailableExpressions::kNoExpr)
+          available += avail.available(bb, id);
+      }
+    long bad = naiveMismatches(f, cfg, live);
+    ok &= bad == 0;
+    printf("%8d %7zu %7zu | %9.2f %9.2f %9.2f | %s, %ld reaching defs, "
+           "%ld available\n",
+           regions, cfg.rpo.size(), f.insts.size(), ms(t0, t1), ms(t1, t2),
+           ms(t2, t3), bad ? "liveness MISMATCH" : "liveness ok", reaching,
+           available);
+  }
+  return ok ? 0 : 1;
+}
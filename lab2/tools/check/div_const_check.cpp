@@ -0,0 +1,119 @@
+// Exhaustive check of DivByConst, kept out of code/ so that the compiler
+// sources have a single main. For every divisor in the set below it lowers
+// a one-instruction `div` and `mod`, runs the pass, evaluates the emitted
+// sequence with IR::eval_binary and compares it with the C semantics of
+// eval_binary_op. From lab2, as one command:
+//
+//   g++ -std=c++17 -O2 -Icode -o div_const_check
+//       tools/check/div_const_check.cpp code/opt/div_const.cpp code/ir/ir.cpp
+//       code/analysis/analysis_manager.cpp code/analysis/cfg.cpp
+//       code/analysis/dominators.cpp code/analysis/loops.cpp
+//       code/analysis/liveness.cpp code/analysis/dataflow.cpp
+//       code/semantic/const_eval.cpp code/semantic/type.cpp
+//       code/semantic/initializer.cpp code/ast/tree.cpp
+//       && ./div_const_check
+//
+// Prints the first mismatches and exits with 1 if there are any.
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "opt/div_const.hpp"
+#include "semantic/const_eval.hpp"
+
+using namespace IR;
+
+/// @brief A function returning `arg0 / d` or `arg0 % d`, after div-const
+static FunctionPtr lower(Opcode op, int d) {
+  auto func = Function::create("f", IR::Type::I32, {IR::Type::I32});
+  auto &f = *func;
+  BlockId entry = f.add_block();
+  ValueId res = f.create(op, IR::Type::I32, {f.args[0], f.const_int(d)});
+  f.append(entry, res);
+  f.append(entry, f.create(Opcode::Ret, IR::Type::Void, {res}));
+  DivByConst pass;
+  AnalysisManager am;
+  pass.run(f, am);
+  return func;
+}
+
+/// @brief Evaluate the straight-line function `f` on `x`
+static int run(const Function &f, int x) {
+  std::vector<int> v(f.insts.size(), 0);
+  for (ValueId id = 0; id < f.insts.size(); id++)
+    if (f[id].op == Opcode::Const) v[id] = f[id].imm;
+  v[f.args[0]] = x;
+  for (auto id : f.blocks[0].insts) {
+    auto &inst = f[id];
+    if (inst.op == Opcode::Ret) return v[inst.ops[0]];
+    v[id] = *eval_binary(inst.op, v[inst.ops[0]], v[inst.ops[1]]);
+  }
+  return 0;
+}
+
+int main() {
+  std::mt19937 rng(1);
+  // 小除数全部检查，再加上 2 的幂及其邻居、边界值和随机除数
+  std::vector<int> divisors;
+  for (int d = -300; d <= 300; d++) divisors.push_back(d);
+  for (int k = 0; k < 31; k++) {
+    int p = 1 << k;
+    divisors.insert(divisors.end(), {p, -p, p + 1, p - 1, -p - 1});
+  }
+  divisors.insert(divisors.end(), {INT_MIN, INT_MIN + 1, INT_MAX, 641,
+                                   6700417, 1000007, 1000000007,
+                                   -1000000007});
+  for (int i = 0; i < 2000; i++) divisors.push_back(rng());
+  // 除以零留给运行时报错，不在检查范围内
+  divisors.erase(std::remove(divisors.begin(), divisors.end(), 0),
+                 divisors.end());
+
+  std::vector<int> dividends = {0,       1,           -1,     2,
+                                -2,      INT_MIN,     INT_MIN + 1,
+                                INT_MAX, INT_MAX - 1};
+  for (int k = 0; k < 31; k++)
+    for (int e = -2; e <= 2; e++) {
+      dividends.push_back((1 << k) + e);
+      dividends.push_back(-(1 << k) + e);
+    }
+  for (int i = 0; i < 3000; i++) dividends.push_back(rng());
+
+  long long checks = 0, failures = 0;
+  auto check = [&](const Function &f, BinaryOp op, int x, int d) {
+    int want = *eval_binary_op(op, x, d), got = run(f, x);
+    checks++;
+    if (want == got) return;
+    if (failures++ < 20)
+      printf("%d %c %d: want %d, got %d\n", x,
+             op == BinaryOp::Div ? '/' : '%', d, want, got);
+  };
+  for (auto op : {BinaryOp::Div, BinaryOp::Mod}) {
+    Opcode opcode = op == BinaryOp::Div ? Opcode::Div : Opcode::Mod;
+    for (int d : divisors) {
+      auto f = lower(opcode, d);
+      for (auto id : f->blocks[0].insts)
+        if (f->insts[id].op == opcode) {
+          printf("not rewritten: %c %d\n",
+                 op == BinaryOp::Div ? '/' : '%', d);
+          failures++;
+        }
+      for (int x : dividends) check(*f, op, x, d);
+      // 商恰好变化的位置附近
+      for (int m = -3; m <= 3; m++) {
+        check(*f, op, (int)((uint32_t)d + m), d);
+        check(*f, op, (int)((uint32_t)d * 3 + m), d);
+      }
+    }
+    // 少量除数扫过整个被除数范围
+    for (int d : {3, -3, 7, 10, -10, 16, -16, 641, INT_MIN, 1000000007}) {
+      auto f = lower(opcode, d);
+      for (int64_t x = INT_MIN; x <= INT_MAX; x += 997) check(*f, op, x, d);
+    }
+  }
+  printf("%lld checks, %lld failures\n", checks, failures);
+  return failures ? 1 : 0;
+}